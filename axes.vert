@@ -1,10 +1,17 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 view;
-uniform mat4 projection;
+// camera matrices shared by every program, see cameraBlock.h
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	vec4 cameraPosition;
+	vec4 viewport;
+};
 
 void main()
 {
-	gl_Position = projection * view * vec4(aPos, 1.0f);
+	gl_Position = viewProjection * vec4(aPos, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include"cameraBlock.h"
+#include<glm/gtc/matrix_transform.hpp>
+
+// Constructor that generates the buffer and binds it at CAMERA_BLOCK_BINDING
+CameraBlock::CameraBlock(float nearPlane, float farPlane) : data(), nearPlane(nearPlane), farPlane(farPlane), valid(false), position(0.0f), front(0.0f), up(0.0f), zoom(0.0f), width(0), height(0)
+{
+	glGenBuffers(1, &UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlockData), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, UBO);
+}
+
+// Moves the near and far plane, the matrices are recomputed by the next Update if they changed
+void CameraBlock::SetPlanes(float nearPlane, float farPlane)
+{
+	if (nearPlane == this->nearPlane && farPlane == this->farPlane)
+		return;
+	this->nearPlane = nearPlane;
+	this->farPlane = farPlane;
+	valid = false;
+}
+
+// Recomputes the matrices and uploads them if the camera or the viewport changed, returns whether it did
+bool CameraBlock::Update(const Camera& camera, int width, int height)
+{
+	// A minimized window has no area, keep the last matrices
+	if (width <= 0 || height <= 0)
+		return false;
+	if (valid && camera.Position == position && camera.Front == front && camera.Up == up && camera.Zoom == zoom && width == this->width && height == this->height)
+		return false;
+
+	position = camera.Position;
+	front = camera.Front;
+	up = camera.Up;
+	zoom = camera.Zoom;
+	this->width = width;
+	this->height = height;
+	valid = true;
+
+	data.view = camera.GetViewMatrix();
+	data.projection = glm::perspective(glm::radians(zoom), (float)width / (float)height, nearPlane, farPlane);
+	data.viewProjection = data.projection * data.view;
+	data.position = glm::vec4(position, 1.0f);
+	data.viewport = glm::vec4((float)width, (float)height, nearPlane, farPlane);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlockData), &data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	return true;
+}
+
+// Deletes the buffer
+void CameraBlock::Delete()
+{
+	glDeleteBuffers(1, &UBO);
+}
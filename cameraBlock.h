@@ -0,0 +1,57 @@
+#ifndef CAMERA_BLOCK_H
+#define CAMERA_BLOCK_H
+
+#include<glad/glad.h>
+#include<glm/glm.hpp>
+#include"camera.h"
+
+// Uniform buffer binding point of the CameraBlock every program reads
+const GLuint CAMERA_BLOCK_BINDING = 0;
+// Name of the uniform block in the shaders
+const char* const CAMERA_BLOCK_NAME = "CameraBlock";
+
+// std140 layout of the CameraBlock, mat4 and vec4 members need no padding
+struct CameraBlockData
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 viewProjection;
+	// xyz is the camera position in world space
+	glm::vec4 position;
+	// width, height, near and far plane
+	glm::vec4 viewport;
+};
+
+// Uniform buffer holding the camera matrices shared by every program.
+// It is written only when the camera or the viewport changed since the last frame
+class CameraBlock
+{
+public:
+	// Reference ID of the Uniform Buffer Object
+	GLuint UBO;
+	// Contents of the buffer as last uploaded
+	CameraBlockData data;
+
+	// Constructor that generates the buffer and binds it at CAMERA_BLOCK_BINDING
+	CameraBlock(float nearPlane, float farPlane);
+
+	// Moves the near and far plane, the matrices are recomputed by the next Update if they changed
+	void SetPlanes(float nearPlane, float farPlane);
+	// Recomputes the matrices and uploads them if the camera or the viewport changed, returns whether it did
+	bool Update(const Camera& camera, int width, int height);
+	// Deletes the buffer
+	void Delete();
+
+private:
+	float nearPlane;
+	float farPlane;
+	// Camera state the current contents were computed from
+	bool valid;
+	glm::vec3 position;
+	glm::vec3 front;
+	glm::vec3 up;
+	float zoom;
+	int width;
+	int height;
+};
+#endif
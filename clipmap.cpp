@@ -0,0 +1,176 @@
+#include"clipmap.h"
+
+// Cells of a level along each side covered by the next finer level, and the first cell of that hole
+// when the finer level starts at the lower of its two possible places
+static const int CLIPMAP_HOLE_CELLS = (CLIPMAP_SIZE - 1) / 2;
+static const int CLIPMAP_HOLE_START = (CLIPMAP_SIZE - 1) / 4;
+
+// Writes two triangles per cell of a level, like writeGridTriangles of gridTopology.cpp, leaving out the
+// holeCells x holeCells cells from (holeRow, holeCol). Returns the end of the written indices
+static unsigned short* writeLevelTriangles(int holeRow, int holeCol, int holeCells, unsigned short* out)
+{
+	for (int row = 0; row < CLIPMAP_SIZE - 1; row++)
+	{
+		for (int col = 0; col < CLIPMAP_SIZE - 1; col++)
+		{
+			if (row >= holeRow && row < holeRow + holeCells && col >= holeCol && col < holeCol + holeCells)
+				continue;
+			unsigned short topLeft = (unsigned short)(row * CLIPMAP_SIZE + col);
+			unsigned short topRight = (unsigned short)(topLeft + 1);
+			unsigned short bottomLeft = (unsigned short)((row + 1) * CLIPMAP_SIZE + col);
+			unsigned short bottomRight = (unsigned short)(bottomLeft + 1);
+
+			*out++ = topLeft;
+			*out++ = bottomLeft;
+			*out++ = topRight;
+
+			*out++ = topRight;
+			*out++ = bottomLeft;
+			*out++ = bottomRight;
+		}
+	}
+	return out;
+}
+
+// Uploads the indices of one level into a new Element Buffer and returns how many there are
+static GLsizei uploadLevelIndices(int holeRow, int holeCol, int holeCells, std::vector<unsigned short>& scratch, GLuint& EBO)
+{
+	GLsizei count = (GLsizei)(writeLevelTriangles(holeRow, holeCol, holeCells, scratch.data()) - scratch.data());
+	glGenBuffers(1, &EBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned short), scratch.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	return count;
+}
+
+// Constructor that allocates the height texture and builds the indices of the levels
+GeometryClipmap::GeometryClipmap() : levels(0), step(0.0f), cachedKey(), hasData(false)
+{
+	for (int i = 0; i < MAX_CLIPMAP_LEVELS; i++)
+	{
+		origins[i][0] = 0;
+		origins[i][1] = 0;
+		valid[i] = false;
+	}
+
+	glGenVertexArrays(1, &VAO);
+
+	glGenTextures(1, &heightTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, heightTexture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32F, CLIPMAP_SIZE, CLIPMAP_SIZE, MAX_CLIPMAP_LEVELS, 0, GL_RED, GL_FLOAT, NULL);
+	// Only read with texelFetch, but an incomplete texture would read as zero
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// Unbind any Vertex Array so it does not pick up these Element Buffers
+	glBindVertexArray(0);
+	std::vector<unsigned short> scratch((std::size_t)(CLIPMAP_SIZE - 1) * (CLIPMAP_SIZE - 1) * 6);
+	fullIndexCount = uploadLevelIndices(0, 0, 0, scratch, fullEBO);
+	for (int i = 0; i < 4; i++)
+		ringIndexCount = uploadLevelIndices(CLIPMAP_HOLE_START + i / 2, CLIPMAP_HOLE_START + i % 2, CLIPMAP_HOLE_CELLS, scratch, ringEBO[i]);
+}
+
+// Draws every level, finest first, with clipmap.vert
+void GeometryClipmap::Draw(Shader& shader)
+{
+	if (!hasData)
+		return;
+
+	glActiveTexture(GL_TEXTURE0 + CLIPMAP_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, heightTexture);
+	glActiveTexture(GL_TEXTURE0);
+	shader.SetInt("clipmapHeights", CLIPMAP_TEXTURE_UNIT);
+	shader.SetInt("clipmapSize", CLIPMAP_SIZE);
+
+	glBindVertexArray(VAO);
+	float levelStep = step;
+	for (int level = 0; level < levels; level++)
+	{
+		const int* origin = origins[level];
+		shader.SetInt("level", level);
+		shader.SetFloat("levelStep", levelStep);
+		shader.SetIVec2("levelOrigin", origin[0], origin[1]);
+		// where the first sample lies in the layer, never negative so the shader can use %
+		shader.SetIVec2("levelWrap", ((origin[0] % CLIPMAP_SIZE) + CLIPMAP_SIZE) % CLIPMAP_SIZE, ((origin[1] % CLIPMAP_SIZE) + CLIPMAP_SIZE) % CLIPMAP_SIZE);
+		// the coarsest level has nothing to blend into
+		shader.SetInt("morph", level + 1 < levels);
+
+		GLuint EBO = fullEBO;
+		GLsizei count = fullIndexCount;
+		if (level > 0)
+		{
+			// the finer level starts on an even sample, so its hole starts one of two cells in
+			int holeRow = origins[level - 1][0] / 2 - origin[0] - CLIPMAP_HOLE_START;
+			int holeCol = origins[level - 1][1] / 2 - origin[1] - CLIPMAP_HOLE_START;
+			EBO = ringEBO[holeRow * 2 + holeCol];
+			count = ringIndexCount;
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+		glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, 0);
+		levelStep *= 2.0f;
+	}
+	glBindVertexArray(0);
+}
+
+// Vertices and indices submitted by Draw
+std::size_t GeometryClipmap::VertexCount() const
+{
+	return (std::size_t)levels * CLIPMAP_SIZE * CLIPMAP_SIZE;
+}
+
+std::size_t GeometryClipmap::IndexCount() const
+{
+	return levels > 0 ? (std::size_t)fullIndexCount + (std::size_t)(levels - 1) * ringIndexCount : 0;
+}
+
+// Half the side of the area covered by the coarsest level
+float GeometryClipmap::Extent() const
+{
+	return levels > 0 ? std::ldexp(step, levels - 1) * (CLIPMAP_SIZE - 1) * 0.5f : 0.0f;
+}
+
+// Deletes the Vertex Array, the height texture and the Element Buffers
+void GeometryClipmap::Delete()
+{
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteTextures(1, &heightTexture);
+	glDeleteBuffers(1, &fullEBO);
+	glDeleteBuffers(4, ringEBO);
+}
+
+// Copies rowCount x colCount heights into the layer of a level, wrapping around its edges
+void GeometryClipmap::Upload(int level, int firstRow, int rowCount, int firstCol, int colCount, const float* heights)
+{
+	// Sample (row, col) is stored at texel (col mod size, row mod size), so a region splits into at most four pieces
+	int layerRow = ((firstRow % CLIPMAP_SIZE) + CLIPMAP_SIZE) % CLIPMAP_SIZE;
+	int layerCol = ((firstCol % CLIPMAP_SIZE) + CLIPMAP_SIZE) % CLIPMAP_SIZE;
+	int rowSplit = std::min(rowCount, CLIPMAP_SIZE - layerRow);
+	int colSplit = std::min(colCount, CLIPMAP_SIZE - layerCol);
+	const int rowStarts[2] = { 0, rowSplit };
+	const int rowCounts[2] = { rowSplit, rowCount - rowSplit };
+	const int colStarts[2] = { 0, colSplit };
+	const int colCounts[2] = { colSplit, colCount - colSplit };
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, heightTexture);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, colCount);
+	for (int r = 0; r < 2; r++)
+	{
+		for (int c = 0; c < 2; c++)
+		{
+			if (rowCounts[r] == 0 || colCounts[c] == 0)
+				continue;
+			const float* piece = heights + (std::size_t)rowStarts[r] * colCount + colStarts[c];
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, (layerCol + colStarts[c]) % CLIPMAP_SIZE, (layerRow + rowStarts[r]) % CLIPMAP_SIZE, level,
+				colCounts[c], rowCounts[r], 1, GL_RED, GL_FLOAT, piece);
+		}
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+// Largest integer at most value / 2
+int GeometryClipmap::floorHalf(int value)
+{
+	return value >= 0 ? value / 2 : -((1 - value) / 2);
+}
@@ -0,0 +1,149 @@
+#ifndef CLIPMAP_H
+#define CLIPMAP_H
+
+#include<glad/glad.h>
+#include<algorithm>
+#include<cmath>
+#include<cstddef>
+#include<cstdlib>
+#include<vector>
+
+#include"gridMesher.h"
+#include"shaderClass.h"
+#include"surfaceKernels.h"
+#include"surfaceMesh.h"
+#include"threadPool.h"
+
+// Samples along each side of a level, 4m + 1 so a level starts on an even sample of the next
+// coarser one and the hole it leaves there can only start at two places per axis. 129 x 129
+// vertices can be indexed with 16 bits
+const int CLIPMAP_SIZE = 129;
+// Most levels, each one doubling the extent of the one inside it
+const int MAX_CLIPMAP_LEVELS = 16;
+// Texture unit of the height texture array, unit 0 is left to ImGui and 1 to the colormaps
+const GLuint CLIPMAP_TEXTURE_UNIT = 2;
+
+// Geometry clipmap for plotting domains far larger than a uniform grid can cover: nested square
+// grids of CLIPMAP_SIZE samples, each with twice the spacing of the one inside it, centred on the
+// camera. The vertex count only depends on the number of levels, never on the domain.
+// The heights of every level are one layer of a float texture array addressed toroidally by the
+// global sample index, so when the camera moves only the rows and columns it uncovers are evaluated
+// and uploaded. clipmap.vert rebuilds x and z from gl_VertexID and morphs the outer band of each
+// level into the next coarser one so the levels meet without cracks
+class GeometryClipmap
+{
+public:
+	// Reference ID of the Vertex Array, empty since the vertices carry no attributes
+	GLuint VAO;
+	// Reference ID of the GL_TEXTURE_2D_ARRAY holding the heights, one layer per level
+	GLuint heightTexture;
+
+	// Constructor that allocates the height texture and builds the indices of the levels
+	GeometryClipmap();
+
+	// Centres levelCount levels, the finest with baseStep between samples, on (centerX, centerZ) and
+	// evaluates the samples they uncovered with heightFn. Everything is evaluated again when key,
+	// baseStep or levelCount change
+	template <typename HeightFn>
+	void Update(const SurfaceKey& key, const HeightFn& heightFn, float baseStep, int levelCount, float centerX, float centerZ, ThreadPool& threads)
+	{
+		levelCount = std::max(1, std::min(levelCount, MAX_CLIPMAP_LEVELS));
+		if (!hasData || key != cachedKey || baseStep != step || levelCount != levels)
+		{
+			for (int i = 0; i < MAX_CLIPMAP_LEVELS; i++)
+				valid[i] = false;
+			cachedKey = key;
+			step = baseStep;
+			levels = levelCount;
+			hasData = true;
+		}
+
+		// Every level is centred on an even sample, and each coarser centre is the even sample of its
+		// own spacing at or below the finer one, so the finer level always starts on an even sample
+		int centerRow = 2 * (int)std::floor(centerX / (2.0f * step));
+		int centerCol = 2 * (int)std::floor(centerZ / (2.0f * step));
+		float levelStep = step;
+		for (int level = 0; level < levels; level++)
+		{
+			int originRow = centerRow - (CLIPMAP_SIZE - 1) / 2;
+			int originCol = centerCol - (CLIPMAP_SIZE - 1) / 2;
+			int movedRows = originRow - origins[level][0];
+			int movedCols = originCol - origins[level][1];
+			if (!valid[level] || std::abs(movedRows) >= CLIPMAP_SIZE || std::abs(movedCols) >= CLIPMAP_SIZE)
+				EvaluateRegion(heightFn, level, levelStep, originRow, CLIPMAP_SIZE, originCol, CLIPMAP_SIZE, threads);
+			else
+			{
+				// Rows that came into view, over every column of the new position
+				if (movedRows > 0)
+					EvaluateRegion(heightFn, level, levelStep, origins[level][0] + CLIPMAP_SIZE, movedRows, originCol, CLIPMAP_SIZE, threads);
+				else if (movedRows < 0)
+					EvaluateRegion(heightFn, level, levelStep, originRow, -movedRows, originCol, CLIPMAP_SIZE, threads);
+				// then the columns that came into view, over the rows that stayed
+				int keptRow = std::max(originRow, origins[level][0]);
+				int keptRows = CLIPMAP_SIZE - std::abs(movedRows);
+				if (movedCols > 0)
+					EvaluateRegion(heightFn, level, levelStep, keptRow, keptRows, origins[level][1] + CLIPMAP_SIZE, movedCols, threads);
+				else if (movedCols < 0)
+					EvaluateRegion(heightFn, level, levelStep, keptRow, keptRows, originCol, -movedCols, threads);
+			}
+			origins[level][0] = originRow;
+			origins[level][1] = originCol;
+			valid[level] = true;
+
+			centerRow = 2 * floorHalf(centerRow / 2);
+			centerCol = 2 * floorHalf(centerCol / 2);
+			levelStep *= 2.0f;
+		}
+	}
+
+	// Draws every level, finest first, with clipmap.vert
+	void Draw(Shader& shader);
+	// Vertices and indices submitted by Draw
+	std::size_t VertexCount() const;
+	std::size_t IndexCount() const;
+	// Half the side of the area covered by the coarsest level
+	float Extent() const;
+	// Deletes the Vertex Array, the height texture and the Element Buffers
+	void Delete();
+
+private:
+	// Evaluates rowCount x colCount samples of a level from global sample (firstRow, firstCol) and uploads them
+	template <typename HeightFn>
+	void EvaluateRegion(const HeightFn& heightFn, int level, float levelStep, int firstRow, int rowCount, int firstCol, int colCount, ThreadPool& threads)
+	{
+		staging.resize((std::size_t)rowCount * colCount);
+		float* heights = staging.data();
+		int blockRows = std::max(1, GRID_BLOCK_SAMPLES / colCount);
+		threads.ParallelFor(rowCount, blockRows, [&](int begin, int end)
+		{
+			// x and z come from the global sample index, so every level samples shared points alike
+			for (int row = begin; row < end; row++)
+				evaluateRow(heightFn, (float)(firstRow + row) * levelStep, 0.0f, levelStep, firstCol, colCount, heights + (std::size_t)row * colCount);
+		});
+		Upload(level, firstRow, rowCount, firstCol, colCount, heights);
+	}
+
+	// Copies rowCount x colCount heights into the layer of a level, wrapping around its edges
+	void Upload(int level, int firstRow, int rowCount, int firstCol, int colCount, const float* heights);
+	// Largest integer at most value / 2
+	static int floorHalf(int value);
+
+	// Indices of the full finest level, and of a coarser level around the hole of the finer one
+	// for each of the two places per axis it can start at
+	GLuint fullEBO;
+	GLuint ringEBO[4];
+	GLsizei fullIndexCount;
+	GLsizei ringIndexCount;
+
+	// Global row and column of the first sample of every level, and whether its layer holds them
+	int origins[MAX_CLIPMAP_LEVELS][2];
+	bool valid[MAX_CLIPMAP_LEVELS];
+	int levels;
+	float step;
+	// Function the layers were evaluated for
+	SurfaceKey cachedKey;
+	bool hasData;
+	// Heights of the region being evaluated, kept so moving does not allocate
+	std::vector<float> staging;
+};
+#endif
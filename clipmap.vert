@@ -0,0 +1,92 @@
+#version 330 core
+// Vertex shader of GeometryClipmap (clipmap.h). Every level is the same grid of clipmapSize x clipmapSize
+// vertices without attributes: x and z follow from gl_VertexID and the level's origin, the height is
+// read from the level's layer of clipmapHeights, which is addressed toroidally
+
+out vec3 fragPos;
+// position and normal in world space for the lighting in default.frag
+out vec3 worldPos;
+out vec3 fragNormal;
+// row and column of the vertex in its level, the cell edges of the wireframe lie at whole numbers
+out vec2 gridCoord;
+// read by default.frag, only quantized meshes have samples without a height
+out float missingHeight;
+
+// camera matrices shared by every program, see cameraBlock.h
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	vec4 cameraPosition;
+	vec4 viewport;
+};
+uniform mat4 model;
+
+// heights of every level, one layer each, sample (row, col) at texel (col, row) modulo clipmapSize
+uniform sampler2DArray clipmapHeights;
+uniform int clipmapSize;
+// level being drawn, its spacing, the global row and column of its first vertex and where that vertex lies in the layer
+uniform int level;
+uniform float levelStep;
+uniform ivec2 levelOrigin;
+uniform ivec2 levelWrap;
+// set on every level but the coarsest, whose outer band then blends into the next level
+uniform bool morph;
+
+// Height of the sample at row and column of the level, clamped to the level
+float levelHeight(int row, int col)
+{
+	row = clamp(row, 0, clipmapSize - 1);
+	col = clamp(col, 0, clipmapSize - 1);
+	ivec2 texel = (levelWrap + ivec2(row, col)) % clipmapSize;
+	return texelFetch(clipmapHeights, ivec3(texel.y, texel.x, level), 0).r;
+}
+
+void main()
+{
+	int row = gl_VertexID / clipmapSize;
+	int col = gl_VertexID - row * clipmapSize;
+	float height = levelHeight(row, col);
+
+	if (morph)
+	{
+		// What the next level shows here: its samples are the even ones of this level, and in between it
+		// interpolates along the edges and the diagonals of its cells, split like those of gridTopology.cpp.
+		// The level starts on an even sample, so local and global parity agree
+		bool oddRow = (row & 1) == 1;
+		bool oddCol = (col & 1) == 1;
+		float coarse = height;
+		if (oddRow && oddCol)
+			coarse = 0.5 * (levelHeight(row + 1, col - 1) + levelHeight(row - 1, col + 1));
+		else if (oddRow)
+			coarse = 0.5 * (levelHeight(row - 1, col) + levelHeight(row + 1, col));
+		else if (oddCol)
+			coarse = 0.5 * (levelHeight(row, col - 1) + levelHeight(row, col + 1));
+
+		// fully coarse on the outermost ring, where the vertices meet the edges of the next level
+		float halfSize = float(clipmapSize - 1) * 0.5;
+		float band = float(clipmapSize - 1) * 0.1;
+		float edgeDistance = max(abs(float(row) - halfSize), abs(float(col) - halfSize));
+		height = mix(height, coarse, clamp((edgeDistance - (halfSize - band)) / band, 0.0, 1.0));
+	}
+
+	// normal from central differences, one sided on the edges of the level
+	int above = max(row - 1, 0);
+	int below = min(row + 1, clipmapSize - 1);
+	int left = max(col - 1, 0);
+	int right = min(col + 1, clipmapSize - 1);
+	float slopeX = (levelHeight(below, col) - levelHeight(above, col)) / float(below - above);
+	float slopeZ = (levelHeight(row, right) - levelHeight(row, left)) / float(right - left);
+	vec3 normal = normalize(vec3(-slopeX, levelStep, -slopeZ));
+
+	ivec2 globalSample = levelOrigin + ivec2(row, col);
+	vec3 pos = vec3(float(globalSample.x) * levelStep, height, float(globalSample.y) * levelStep);
+	vec4 world = model * vec4(pos, 1.0f);
+	gl_Position = viewProjection * world;
+	fragPos = pos;
+	worldPos = world.xyz;
+	fragNormal = mat3(model) * normal;
+	gridCoord = vec2(globalSample);
+	missingHeight = 0.0;
+}
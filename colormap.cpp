@@ -0,0 +1,108 @@
+#include"colormap.h"
+
+#include<cmath>
+
+// Polynomial fit of matplotlib's viridis by Matt Zucker, coefficients of t^0 to t^6 per channel
+static const float VIRIDIS[7][3] = {
+	{ 0.2777273272234177f, 0.005407344544966578f, 0.3340998053353061f },
+	{ 0.1050930431085774f, 1.404613529898575f, 1.384590162594685f },
+	{ -0.3308618287255563f, 0.214847559468213f, 0.09509516302823659f },
+	{ -4.634230498983486f, -5.799100973351585f, -19.33244095627987f },
+	{ 6.228269936347081f, 14.17993336680509f, 56.69055260068105f },
+	{ 4.776384997670288f, -13.74514537774601f, -65.35303263337234f },
+	{ -5.435455855934631f, 4.645852612178535f, 26.3124352495832f }
+};
+
+// Polynomial approximation of Google's turbo, coefficients of t^0 to t^5 per channel
+static const float TURBO[6][3] = {
+	{ 0.13572138f, 0.09140261f, 0.10667330f },
+	{ 4.61539260f, 2.19418839f, 12.64194608f },
+	{ -42.66032258f, 4.84296658f, -60.58204836f },
+	{ 132.13108234f, -14.18503333f, 110.36276771f },
+	{ -152.94239396f, 4.27729857f, -89.90310912f },
+	{ 59.28637943f, 2.82956604f, 27.34824973f }
+};
+
+// Kenneth Moreland's cool to warm map sampled at nine evenly spaced points
+static const unsigned char COOLWARM[9][3] = {
+	{ 59, 76, 192 }, { 98, 130, 234 }, { 141, 176, 254 }, { 184, 208, 249 }, { 221, 221, 221 },
+	{ 245, 196, 173 }, { 244, 154, 123 }, { 222, 96, 77 }, { 180, 4, 38 }
+};
+
+// Converts a channel in [0, 1] to a byte, clamping what the polynomials overshoot
+static unsigned char toByte(float value)
+{
+	value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	return (unsigned char)std::floor(value * 255.0f + 0.5f);
+}
+
+// Evaluates the polynomial of each channel at t with Horner's rule
+template <int Terms>
+static void evaluatePolynomial(const float (&coefficients)[Terms][3], float t, unsigned char* out)
+{
+	for (int channel = 0; channel < 3; channel++)
+	{
+		float value = coefficients[Terms - 1][channel];
+		for (int term = Terms - 2; term >= 0; term--)
+			value = value * t + coefficients[term][channel];
+		out[channel] = toByte(value);
+	}
+}
+
+// Writes COLORMAP_SIZE RGB texels of the colormap into out
+void buildColormap(ColormapKind kind, unsigned char* out)
+{
+	for (int i = 0; i < COLORMAP_SIZE; i++, out += 3)
+	{
+		float t = (float)i / (COLORMAP_SIZE - 1);
+		if (kind == COLORMAP_VIRIDIS)
+			evaluatePolynomial(VIRIDIS, t, out);
+		else if (kind == COLORMAP_TURBO)
+			evaluatePolynomial(TURBO, t, out);
+		else
+		{
+			// linear between the two nearest samples
+			float position = t * 8.0f;
+			int below = position >= 8.0f ? 7 : (int)position;
+			float fraction = position - below;
+			for (int channel = 0; channel < 3; channel++)
+				out[channel] = toByte((COOLWARM[below][channel] + (COOLWARM[below + 1][channel] - COOLWARM[below][channel]) * fraction) / 255.0f);
+		}
+	}
+}
+
+// Constructor that builds every texture and binds the first one
+Colormap::Colormap()
+{
+	unsigned char texels[COLORMAP_SIZE * 3];
+	glGenTextures(COLORMAP_COUNT, textures);
+	glActiveTexture(GL_TEXTURE0 + COLORMAP_TEXTURE_UNIT);
+	for (int i = 0; i < COLORMAP_COUNT; i++)
+	{
+		buildColormap((ColormapKind)i, texels);
+		glBindTexture(GL_TEXTURE_1D, textures[i]);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB8, COLORMAP_SIZE, 0, GL_RGB, GL_UNSIGNED_BYTE, texels);
+		// The height is already normalized, linear filtering hides the steps between texels
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_1D, textures[COLORMAP_VIRIDIS]);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+// Binds the texture of the colormap at COLORMAP_TEXTURE_UNIT
+void Colormap::Bind(ColormapKind kind)
+{
+	glActiveTexture(GL_TEXTURE0 + COLORMAP_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_1D, textures[kind]);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+// Deletes the textures
+void Colormap::Delete()
+{
+	glDeleteTextures(COLORMAP_COUNT, textures);
+}
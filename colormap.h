@@ -0,0 +1,41 @@
+#ifndef COLORMAP_H
+#define COLORMAP_H
+
+#include<glad/glad.h>
+
+// Texture unit the colormaps are bound to, unit 0 is left to ImGui
+const GLuint COLORMAP_TEXTURE_UNIT = 1;
+// Texels of every lookup texture
+const int COLORMAP_SIZE = 256;
+
+// Colormaps the surface can be shaded with
+enum ColormapKind
+{
+	// perceptually uniform, dark blue to yellow
+	COLORMAP_VIRIDIS,
+	// high contrast rainbow without the banding of jet
+	COLORMAP_TURBO,
+	// blue through grey to red, for heights on either side of the middle of the range
+	COLORMAP_DIVERGING,
+	COLORMAP_COUNT
+};
+
+// Writes COLORMAP_SIZE RGB texels of the colormap into out
+void buildColormap(ColormapKind kind, unsigned char* out);
+
+// 1D lookup textures of every colormap, indexed in default.frag by the height normalized by its HeightRange
+class Colormap
+{
+public:
+	// Reference IDs of the textures, in ColormapKind order
+	GLuint textures[COLORMAP_COUNT];
+
+	// Constructor that builds every texture and binds the first one
+	Colormap();
+
+	// Binds the texture of the colormap at COLORMAP_TEXTURE_UNIT
+	void Bind(ColormapKind kind);
+	// Deletes the textures
+	void Delete();
+};
+#endif
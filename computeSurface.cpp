@@ -0,0 +1,92 @@
+#include"computeSurface.h"
+#include"glExtensions.h"
+#include"surfaceMesh.h"
+
+// Invocations per work group, local_size_x of surface.comp
+const int COMPUTE_GROUP_SIZE = 256;
+
+// Constructor that builds the compute program when the context supports it, reducing into rangeBuffer
+ComputeSurface::ComputeSurface(GLuint rangeBuffer) : rangeBuffer(rangeBuffer)
+{
+	if (!GLAD_GL_ARB_compute_shader)
+		return;
+
+	program.reset(new Shader("surface.comp"));
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program->ID, GL_LINK_STATUS, &linked);
+	if (linked != GL_TRUE)
+	{
+		program->Delete();
+		program.reset();
+	}
+}
+
+// Returns true when surfaces can be generated on the GPU
+bool ComputeSurface::IsAvailable() const
+{
+	return program != nullptr;
+}
+
+// The compute program, which writes heights and positions alike. Activate it and set the function uniforms before generating
+Shader& ComputeSurface::Program()
+{
+	return *program;
+}
+
+// Writes the float height and packed normal of every sample of grid into buffer and normalBuffer, chunk after chunk
+void ComputeSurface::GenerateGrid(const ChunkedGrid& grid, GLuint buffer, GLuint normalBuffer)
+{
+	Begin(buffer, normalBuffer);
+	for (std::size_t i = 0; i < grid.chunks.size(); i++)
+	{
+		setGridUniforms(*program, grid.chunks[i], (GLint)grid.offsets[i]);
+		Dispatch((int)grid.chunks[i].SampleCount());
+	}
+	End();
+}
+
+// Writes rows x cols torus positions and packed normals into buffer and normalBuffer
+void ComputeSurface::GenerateTorus(int rows, int cols, GLuint buffer, GLuint normalBuffer)
+{
+	Begin(buffer, normalBuffer);
+	program->SetInt("gridColumns", cols);
+	Dispatch(rows * cols);
+	End();
+}
+
+// Starts a new height range and binds the output buffers
+void ComputeSurface::Begin(GLuint buffer, GLuint normalBuffer)
+{
+	const GLuint emptyBounds[2] = { 0xFFFFFFFFu, 0u };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, rangeBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(emptyBounds), emptyBounds);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, rangeBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, normalBuffer);
+}
+
+// Runs surface.comp over count samples
+void ComputeSurface::Dispatch(int count)
+{
+	program->SetInt("vertexCount", count);
+	glDispatchCompute((GLuint)((count + COMPUTE_GROUP_SIZE - 1) / COMPUTE_GROUP_SIZE), 1, 1);
+}
+
+// Makes the results visible to the draws and shaders that read them next
+void ComputeSurface::End()
+{
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_UNIFORM_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+}
+
+// Deletes the program
+void ComputeSurface::Delete()
+{
+	if (program == nullptr)
+		return;
+	program->Delete();
+}
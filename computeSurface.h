@@ -0,0 +1,44 @@
+#ifndef COMPUTE_SURFACE_H
+#define COMPUTE_SURFACE_H
+
+#include<glad/glad.h>
+#include<memory>
+
+#include"gridChunks.h"
+#include"shaderClass.h"
+
+// Generates surfaces with surface.comp on GL 4.3+ contexts. The vertices are written into the
+// Vertex Buffer of the mesh bound as a shader storage buffer, so they never pass through the CPU.
+// On older contexts IsAvailable is false and the surfaces are built on the CPU as before
+class ComputeSurface
+{
+public:
+	// Reference ID of the buffer the height range of every generation is reduced into, the Uniform
+	// Buffer of a HeightRange. It stays on the GPU for the shaders that need it
+	GLuint rangeBuffer;
+
+	// Constructor that builds the compute program when the context supports it, reducing into rangeBuffer
+	explicit ComputeSurface(GLuint rangeBuffer);
+
+	// Returns true when surfaces can be generated on the GPU
+	bool IsAvailable() const;
+	// The compute program, which writes heights and positions alike. Activate it and set the function uniforms before generating
+	Shader& Program();
+	// Writes the float height and packed normal of every sample of grid into buffer and normalBuffer, chunk after chunk
+	void GenerateGrid(const ChunkedGrid& grid, GLuint buffer, GLuint normalBuffer);
+	// Writes rows x cols torus positions and packed normals into buffer and normalBuffer
+	void GenerateTorus(int rows, int cols, GLuint buffer, GLuint normalBuffer);
+	// Deletes the program
+	void Delete();
+
+private:
+	std::unique_ptr<Shader> program;
+
+	// Starts a new height range and binds the output buffers
+	void Begin(GLuint buffer, GLuint normalBuffer);
+	// Runs surface.comp over count samples
+	void Dispatch(int count);
+	// Makes the results visible to the draws and shaders that read them next
+	void End();
+};
+#endif
@@ -1,11 +1,101 @@
 #version 330 core
 out vec4 FragColor;
 
-uniform float color;
-
 in vec3 fragPos;
+in vec3 worldPos;
+in vec3 fragNormal;
+in vec2 gridCoord;
+in float missingHeight;
+
+// camera matrices shared by every program, see cameraBlock.h
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	vec4 cameraPosition;
+	vec4 viewport;
+};
+// height range of the plotted surface as order preserving integers, see heightRange.h
+layout (std140) uniform HeightRange
+{
+	uint heightMinBits;
+	uint heightMaxBits;
+};
+// false when the range belongs to another surface than the one drawn, as with GPU Evaluation
+uniform bool useHeightRange;
+// lookup texture indexed by the normalized height, see colormap.h
+uniform sampler1D colormap;
+
+// direction towards the light in world space, and how much of it every side receives
+const vec3 lightDirection = vec3(0.3713907, 0.9284767, 0.0);
+const float ambient = 0.3;
+const float specularStrength = 0.35;
+const float shininess = 32.0;
+
+// WireframeMode of main.cpp: no edges, the edges alone, or the edges drawn over the lit surface
+uniform int wireframe;
+// width of the edges in pixels, and their colour over the surface
+const float lineWidth = 1.0;
+const vec3 lineColor = vec3(0.05);
+
+// Inverse of orderedBits in heightRange.cpp
+float orderedFloat(uint bits)
+{
+	return uintBitsToFloat((bits & 0x80000000u) != 0u ? bits & 0x7FFFFFFFu : ~bits);
+}
+
+// Height of the fragment mapped to [0, 1] over the range of the surface. Without a known range,
+// such as for meshes captured with transform feedback, heights in [-4, 4] span the colormap
+float normalizedHeight()
+{
+	if (useHeightRange && heightMinBits <= heightMaxBits)
+	{
+		float heightMin = orderedFloat(heightMinBits);
+		float heightMax = orderedFloat(heightMaxBits);
+		return (fragPos.y - heightMin) / max(heightMax - heightMin, 1e-6);
+	}
+	return fragPos.y * 0.125 + 0.5;
+}
+
+// Coverage of the fragment by the nearest triangle edge, anti-aliased over one pixel. Cells are split
+// from their lower left to their upper right corner like the indices of gridTopology.cpp
+float edgeCoverage()
+{
+	vec2 cell = fract(gridCoord);
+	// distances to the cell sides and to the diagonal, in pixels
+	vec2 sides = min(cell, 1.0 - cell) / max(fwidth(gridCoord), vec2(1e-6));
+	float diagonal = abs(cell.x + cell.y - 1.0) / max(fwidth(gridCoord.x + gridCoord.y), 1e-6);
+	float distance = min(min(sides.x, sides.y), diagonal);
+	return 1.0 - smoothstep(lineWidth - 0.5, lineWidth + 0.5, distance);
+}
 
 void main()
 {
-	FragColor = vec4(fragPos.y*0.25, 0.5, 0.5, 1.0);
+	// quantized heights cannot hold NaN, triangles around a missing sample are cut out instead
+	if (missingHeight > 0.0)
+		discard;
+	vec3 albedo = texture(colormap, clamp(normalizedHeight(), 0.0, 1.0)).rgb;
+	float edge = wireframe != 0 ? edgeCoverage() : 0.0;
+	if (wireframe == 1)
+	{
+		// only the edges, unlit like the line mode used to draw them
+		if (edge <= 0.0)
+			discard;
+		FragColor = vec4(albedo, edge);
+		return;
+	}
+
+	// surfaces evaluated in surface.vert come without normals, their faces are shaded flat instead
+	vec3 normal = dot(fragNormal, fragNormal) > 1e-6 ? normalize(fragNormal) : normalize(cross(dFdx(worldPos), dFdy(worldPos)));
+	vec3 viewDirection = normalize(cameraPosition.xyz - worldPos);
+	// the surfaces are open, so the side facing the camera is lit
+	if (dot(normal, viewDirection) < 0.0)
+		normal = -normal;
+
+	float diffuse = max(dot(normal, lightDirection), 0.0);
+	vec3 halfway = normalize(lightDirection + viewDirection);
+	float specular = pow(max(dot(normal, halfway), 0.0), shininess) * specularStrength;
+	vec3 lit = albedo * (ambient + diffuse) + vec3(specular);
+	FragColor = vec4(mix(lit, lineColor, edge), 1.0);
 }
\ No newline at end of file
@@ -1,14 +1,63 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 1) in float aHeight;
+// packed unit normal, see packNormal in surfaceKernels.h
+layout (location = 2) in vec4 aNormal;
 
 out vec3 fragPos;
+// position and normal in world space for the lighting in default.frag
+out vec3 worldPos;
+out vec3 fragNormal;
+// row and column of the vertex in the whole grid, the cell edges of the wireframe lie at whole numbers
+out vec2 gridCoord;
+// 1 at samples without a height, default.frag discards the triangles around them
+out float missingHeight;
 
+// camera matrices shared by every program, see cameraBlock.h
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	vec4 cameraPosition;
+	vec4 viewport;
+};
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// compact grid vertices only carry a height, x and z follow from the vertex index.
+// Meshes of full positions are grids as well, only their rows and columns are set
+uniform bool compactGrid;
+uniform vec2 gridOrigin;
+uniform float gridStep;
+// first row and column of the chunk being drawn, its columns and the buffer offset of its first vertex
+uniform ivec2 gridFirst;
+uniform int gridColumns;
+uniform int gridBaseVertex;
+// heights may be stored quantized, this maps them back to world units
+uniform float heightScale;
+uniform float heightBias;
+// heights are HEIGHT_UNORM16, whose largest value is HEIGHT_UNORM16_MISSING (heightFormat.h)
+uniform bool quantizedHeights;
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0f);
-	fragPos = aPos;
+	int index = gl_VertexID - gridBaseVertex;
+	int row = index / gridColumns;
+	int col = index - row * gridColumns;
+	gridCoord = vec2(gridFirst + ivec2(row, col));
+
+	vec3 pos = aPos;
+	missingHeight = 0.0;
+	if (compactGrid)
+	{
+		// a normalized 65535 reads as exactly 1
+		if (quantizedHeights && aHeight == 1.0)
+			missingHeight = 1.0;
+		pos = vec3(gridOrigin.x + float(gridFirst.x + row) * gridStep, aHeight * heightScale + heightBias, gridOrigin.y + float(gridFirst.y + col) * gridStep);
+	}
+	vec4 world = model * vec4(pos, 1.0f);
+	gl_Position = viewProjection * world;
+	fragPos = pos;
+	worldPos = world.xyz;
+	fragNormal = mat3(model) * aNormal.xyz;
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include"feedbackSurface.h"
+#include"surfaceMesh.h"
+
+#include<string>
+#include<vector>
+
+// Outputs of surface.vert captured into the Vertex Buffer and into the Normal Buffer
+static std::vector<std::string> feedbackVaryings(const char* vertexOutput)
+{
+	std::vector<std::string> varyings;
+	varyings.push_back(vertexOutput);
+	varyings.push_back("packedNormal");
+	return varyings;
+}
+
+// Constructor that builds the capturing programs
+FeedbackSurface::FeedbackSurface() : heightProgram("surface.vert", feedbackVaryings("height")), positionProgram("surface.vert", feedbackVaryings("fragPos"))
+{
+	glGenVertexArrays(1, &VAO);
+	// Both programs only ever run to capture, so they always compute the normals
+	heightProgram.Activate();
+	heightProgram.SetInt("generateNormals", 1);
+	positionProgram.Activate();
+	positionProgram.SetInt("generateNormals", 1);
+}
+
+// Program generating heights or positions, activate it and set the function uniforms before generating
+Shader& FeedbackSurface::Program(bool positions)
+{
+	return positions ? positionProgram : heightProgram;
+}
+
+// Captures the float height and packed normal of every sample of grid into buffer and normalBuffer, chunk after chunk
+void FeedbackSurface::GenerateGrid(const ChunkedGrid& grid, GLuint buffer, GLuint normalBuffer)
+{
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBindVertexArray(VAO);
+	for (std::size_t i = 0; i < grid.chunks.size(); i++)
+	{
+		// Every chunk is drawn from vertex 0 and captured at its own place in the buffer
+		const GridSpec& chunk = grid.chunks[i];
+		setGridUniforms(heightProgram, chunk, 0);
+		Capture(buffer, normalBuffer, grid.offsets[i], sizeof(float), (int)chunk.SampleCount());
+	}
+	glBindVertexArray(0);
+	glDisable(GL_RASTERIZER_DISCARD);
+}
+
+// Captures rows x cols torus positions and packed normals into buffer and normalBuffer
+void FeedbackSurface::GenerateTorus(int rows, int cols, GLuint buffer, GLuint normalBuffer)
+{
+	positionProgram.SetInt("gridBaseVertex", 0);
+	positionProgram.SetInt("gridColumns", cols);
+	positionProgram.SetInt("vertexCount", rows * cols);
+
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBindVertexArray(VAO);
+	Capture(buffer, normalBuffer, 0, 3 * sizeof(float), rows * cols);
+	glBindVertexArray(0);
+	glDisable(GL_RASTERIZER_DISCARD);
+}
+
+// Captures count points of vertexSize bytes into buffer and their normals into normalBuffer, from the given vertex onwards
+void FeedbackSurface::Capture(GLuint buffer, GLuint normalBuffer, std::size_t first, std::size_t vertexSize, int count)
+{
+	glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer, (GLintptr)(first * vertexSize), (GLsizeiptr)(count * vertexSize));
+	glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 1, normalBuffer, (GLintptr)(first * NORMAL_SIZE), (GLsizeiptr)(count * NORMAL_SIZE));
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, count);
+	glEndTransformFeedback();
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, 0);
+}
+
+// Deletes the programs and the Vertex Array
+void FeedbackSurface::Delete()
+{
+	heightProgram.Delete();
+	positionProgram.Delete();
+	glDeleteVertexArrays(1, &VAO);
+}
@@ -0,0 +1,38 @@
+#ifndef FEEDBACK_SURFACE_H
+#define FEEDBACK_SURFACE_H
+
+#include<glad/glad.h>
+
+#include"gridChunks.h"
+#include"shaderClass.h"
+
+// Generates surfaces on the GPU of any GL 3.3 context: surface.vert is run over attribute-less points
+// with the rasterizer off and its outputs are captured with transform feedback into the Vertex and
+// Normal Buffers of the mesh. It only runs when the SurfaceKey changes, later frames draw the captured vertices
+class FeedbackSurface
+{
+public:
+	// Reference ID of the Vertex Array, empty since the points carry no attributes
+	GLuint VAO;
+
+	// Constructor that builds the capturing programs
+	FeedbackSurface();
+
+	// Program generating heights or positions, activate it and set the function uniforms before generating
+	Shader& Program(bool positions);
+	// Captures the float height and packed normal of every sample of grid into buffer and normalBuffer, chunk after chunk
+	void GenerateGrid(const ChunkedGrid& grid, GLuint buffer, GLuint normalBuffer);
+	// Captures rows x cols torus positions and packed normals into buffer and normalBuffer
+	void GenerateTorus(int rows, int cols, GLuint buffer, GLuint normalBuffer);
+	// Deletes the programs and the Vertex Array
+	void Delete();
+
+private:
+	// surface.vert capturing height, and capturing fragPos, each along with packedNormal
+	Shader heightProgram;
+	Shader positionProgram;
+
+	// Captures count points of vertexSize bytes into buffer and their normals into normalBuffer, from the given vertex onwards
+	void Capture(GLuint buffer, GLuint normalBuffer, std::size_t first, std::size_t vertexSize, int count);
+};
+#endif
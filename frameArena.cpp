@@ -0,0 +1,72 @@
+#include"frameArena.h"
+
+// Every allocation is aligned for SIMD loads and stores
+static const std::size_t ARENA_ALIGNMENT = 32;
+// Smallest block taken from the heap
+static const std::size_t ARENA_MIN_BLOCK = 64 * 1024;
+
+// Constructor that starts with an empty arena, the first allocations size it
+FrameArena::FrameArena() : offset(0), used(0)
+{
+	blocks.reserve(8);
+}
+
+// Releases every allocation of the current round
+void FrameArena::Reset()
+{
+	// Replace overflowing blocks with a single one that fits the whole round next time
+	if (blocks.size() > 1)
+	{
+		std::size_t total = Capacity();
+		blocks.clear();
+		Block block = { std::unique_ptr<unsigned char[]>(new unsigned char[total + ARENA_ALIGNMENT]), total + ARENA_ALIGNMENT };
+		blocks.push_back(std::move(block));
+	}
+	offset = 0;
+	used = 0;
+}
+
+// Bytes handed out since the last Reset
+std::size_t FrameArena::Used() const
+{
+	return used;
+}
+
+// Bytes held by the arena
+std::size_t FrameArena::Capacity() const
+{
+	std::size_t total = 0;
+	for (std::size_t i = 0; i < blocks.size(); i++)
+		total += blocks[i].size;
+	return total;
+}
+
+void* FrameArena::AllocateBytes(std::size_t size)
+{
+	// Align the address itself, new[] only guarantees alignment for fundamental types
+	if (!blocks.empty())
+	{
+		Block& block = blocks.back();
+		std::size_t address = (std::size_t)(block.data.get() + offset);
+		std::size_t padding = (ARENA_ALIGNMENT - address % ARENA_ALIGNMENT) % ARENA_ALIGNMENT;
+		if (offset + padding + size <= block.size)
+		{
+			void* result = block.data.get() + offset + padding;
+			offset += padding + size;
+			used += size;
+			return result;
+		}
+	}
+
+	// Out of room: start a new block at least twice as big as everything held so far
+	std::size_t blockSize = size + ARENA_ALIGNMENT;
+	std::size_t grown = 2 * Capacity();
+	if (blockSize < grown)
+		blockSize = grown;
+	if (blockSize < ARENA_MIN_BLOCK)
+		blockSize = ARENA_MIN_BLOCK;
+	Block block = { std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize };
+	blocks.push_back(std::move(block));
+	offset = 0;
+	return AllocateBytes(size);
+}
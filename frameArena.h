@@ -0,0 +1,48 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include<cstddef>
+#include<memory>
+#include<vector>
+
+// Linear allocator for scratch arrays that live until the next Reset, such as the vertices of one
+// mesh rebuild. Allocating only bumps an offset and Reset frees everything at once. When a round
+// needs more than the current block, extra blocks are taken and merged into one big enough block
+// at the next Reset, so a steady workload stops touching the heap after its first round
+class FrameArena
+{
+public:
+	// Constructor that starts with an empty arena, the first allocations size it
+	FrameArena();
+
+	// Returns uninitialized storage for count objects of type T, valid until the next Reset
+	template <typename T>
+	T* Allocate(std::size_t count)
+	{
+		return static_cast<T*>(AllocateBytes(count * sizeof(T)));
+	}
+
+	// Releases every allocation of the current round
+	void Reset();
+	// Bytes handed out since the last Reset
+	std::size_t Used() const;
+	// Bytes held by the arena
+	std::size_t Capacity() const;
+
+private:
+	void* AllocateBytes(std::size_t size);
+
+	struct Block
+	{
+		std::unique_ptr<unsigned char[]> data;
+		std::size_t size;
+	};
+
+	// The first block is the one kept between rounds, the rest overflowed during this round
+	std::vector<Block> blocks;
+	// Bytes used in the last block
+	std::size_t offset;
+	// Bytes handed out this round, all blocks together
+	std::size_t used;
+};
+#endif
@@ -0,0 +1,60 @@
+#include"frustum.h"
+
+#include<cfloat>
+
+// Box containing every point, for geometry whose extent is not known on the CPU
+BoundingBox BoundingBox::Everything()
+{
+	// Finite so the plane tests never compute infinity minus infinity
+	BoundingBox box = { glm::vec3(-FLT_MAX), glm::vec3(FLT_MAX) };
+	return box;
+}
+
+// Box around every sample of a grid chunk whose heights lie within heights
+BoundingBox chunkBox(const GridSpec& grid, const HeightBounds& heights)
+{
+	// Rows run along x and columns along z, the last sample is (rows - 1, cols - 1) steps from the first
+	BoundingBox box;
+	box.min = glm::vec3(grid.originX + grid.firstRow * grid.step, heights.min, grid.originZ + grid.firstCol * grid.step);
+	box.max = glm::vec3(grid.originX + (grid.firstRow + grid.rows - 1) * grid.step, heights.max, grid.originZ + (grid.firstCol + grid.cols - 1) * grid.step);
+	// A chunk of NaN heights only has its extent along x and z
+	if (heights.IsEmpty())
+	{
+		box.min.y = -FLT_MAX;
+		box.max.y = FLT_MAX;
+	}
+	return box;
+}
+
+// Constructor that extracts the planes from matrix, which maps model space to clip space
+Frustum::Frustum(const glm::mat4& matrix)
+{
+	// Gribb and Hartmann: a point is inside when -w <= x, y, z <= w, each a dot product with a row of the matrix
+	glm::vec4 rowX(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+	glm::vec4 rowY(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+	glm::vec4 rowZ(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+	glm::vec4 rowW(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+	planes[0] = rowW + rowX;
+	planes[1] = rowW - rowX;
+	planes[2] = rowW + rowY;
+	planes[3] = rowW - rowY;
+	planes[4] = rowW + rowZ;
+	planes[5] = rowW - rowZ;
+	// Normalized so the distances of huge boxes stay finite
+	for (int i = 0; i < 6; i++)
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+// Returns true when part of the box may be inside, boxes that are not are certainly outside
+bool Frustum::Intersects(const BoundingBox& box) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		const glm::vec4& plane = planes[i];
+		// The corner furthest along the plane normal is outside only when the whole box is
+		glm::vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x, plane.y >= 0.0f ? box.max.y : box.min.y, plane.z >= 0.0f ? box.max.z : box.min.z);
+		if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,35 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include<glm/glm.hpp>
+
+#include"gridMesher.h"
+
+// Axis aligned box in model space
+struct BoundingBox
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	// Box containing every point, for geometry whose extent is not known on the CPU
+	static BoundingBox Everything();
+};
+
+// Box around every sample of a grid chunk whose heights lie within heights
+BoundingBox chunkBox(const GridSpec& grid, const HeightBounds& heights);
+
+// The six planes of a view volume, used to skip chunks that cannot be on screen
+class Frustum
+{
+public:
+	// Constructor that extracts the planes from matrix, which maps model space to clip space
+	explicit Frustum(const glm::mat4& matrix);
+
+	// Returns true when part of the box may be inside, boxes that are not are certainly outside
+	bool Intersects(const BoundingBox& box) const;
+
+private:
+	// a * x + b * y + c * z + d >= 0 inside every plane
+	glm::vec4 planes[6];
+};
+#endif
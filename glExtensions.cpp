@@ -0,0 +1,66 @@
+#include"glExtensions.h"
+
+#include<cstring>
+
+int GLAD_GL_ARB_buffer_storage = 0;
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = nullptr;
+int GLAD_GL_ARB_get_program_binary = 0;
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = nullptr;
+int GLAD_GL_ARB_compute_shader = 0;
+PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = nullptr;
+PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = nullptr;
+
+// Returns true when the current context lists the named extension
+bool hasGLExtension(const char* name)
+{
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint i = 0; i < count; i++)
+	{
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension != nullptr && std::strcmp(extension, name) == 0)
+			return true;
+	}
+	return false;
+}
+
+// Returns true when the context version is at least major.minor
+static bool hasGLVersion(int major, int minor)
+{
+	GLint contextMajor = 0;
+	GLint contextMinor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+	glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+	return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+// Checks the context for every optional feature and loads its entry points, call once after gladLoadGLLoader
+void loadGLExtensions(GLADloadproc load)
+{
+	if (hasGLVersion(4, 4) || hasGLExtension("GL_ARB_buffer_storage"))
+	{
+		glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+		GLAD_GL_ARB_buffer_storage = glad_glBufferStorage != nullptr;
+	}
+
+	if (hasGLVersion(4, 1) || hasGLExtension("GL_ARB_get_program_binary"))
+	{
+		glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+		glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+		glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+		// A driver may expose the entry points but no format to save programs in
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		GLAD_GL_ARB_get_program_binary = glad_glGetProgramBinary != nullptr && glad_glProgramBinary != nullptr && glad_glProgramParameteri != nullptr && formats > 0;
+	}
+
+	// Compute programs are only useful here when they can write into buffers
+	if (hasGLVersion(4, 3) || (hasGLExtension("GL_ARB_compute_shader") && hasGLExtension("GL_ARB_shader_storage_buffer_object")))
+	{
+		glad_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+		glad_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+		GLAD_GL_ARB_compute_shader = glad_glDispatchCompute != nullptr && glad_glMemoryBarrier != nullptr;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include<glad/glad.h>
+
+// Optional features beyond the GL 3.3 core profile glad was generated for. The entry points are
+// loaded at runtime and the flags tell whether the context has them, following glad's naming
+
+// GL_ARB_buffer_storage (core in 4.4): immutable buffers that can stay mapped while drawing
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+extern int GLAD_GL_ARB_buffer_storage;
+extern PFNGLBUFFERSTORAGEPROC glad_glBufferStorage;
+#define glBufferStorage glad_glBufferStorage
+
+// GL_ARB_get_program_binary (core in 4.1): linked programs can be saved and reloaded without compiling
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+extern int GLAD_GL_ARB_get_program_binary;
+extern PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC glad_glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri;
+#define glGetProgramBinary glad_glGetProgramBinary
+#define glProgramBinary glad_glProgramBinary
+#define glProgramParameteri glad_glProgramParameteri
+
+// GL_ARB_compute_shader with GL_ARB_shader_storage_buffer_object (core in 4.3): compute programs writing into buffers
+#define GL_COMPUTE_SHADER 0x91B9
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#define GL_ELEMENT_ARRAY_BARRIER_BIT 0x00000002
+#define GL_UNIFORM_BARRIER_BIT 0x00000004
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+extern int GLAD_GL_ARB_compute_shader;
+extern PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute;
+extern PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier;
+#define glDispatchCompute glad_glDispatchCompute
+#define glMemoryBarrier glad_glMemoryBarrier
+
+// Returns true when the current context lists the named extension
+bool hasGLExtension(const char* name);
+// Checks the context for every optional feature and loads its entry points, call once after gladLoadGLLoader
+void loadGLExtensions(GLADloadproc load);
+#endif
@@ -0,0 +1,66 @@
+#include"gpuSurface.h"
+#include"surfaceMesh.h"
+
+// Constructor that generates the Vertex Array
+GpuSurface::GpuSurface() : indexCount(0), drawnChunks(0), cacheBefore(), cacheAfter()
+{
+	glGenVertexArrays(1, &VAO);
+}
+
+// Draws the chunks of the grid that may be inside the frustum, every chunk when it is null, with the given shader,
+// which must already be active and have its function uniforms set. The heights are unknown, so chunks are only culled along x and z
+void GpuSurface::Draw(Shader& shader, const ChunkedGrid& grid, GridLayout layout, GridTopologyRegistry& topologies, const Frustum* frustum)
+{
+	glBindVertexArray(VAO);
+	indexCount = 0;
+	drawnChunks = 0;
+	cacheBefore = VertexCacheStats();
+	cacheAfter = VertexCacheStats();
+	// Topology whose Element Buffer this call bound into the Vertex Array
+	const GridTopology* topology = nullptr;
+	for (std::size_t i = 0; i < grid.chunks.size(); i++)
+	{
+		const GridSpec& chunk = grid.chunks[i];
+		if (frustum != nullptr && !frustum->Intersects(chunkBox(chunk, HeightBounds::Empty())))
+			continue;
+		const GridTopology& chunkTopology = topologies.Get(chunk.rows, chunk.cols, layout);
+		if (topology != &chunkTopology)
+		{
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunkTopology.EBO);
+			topology = &chunkTopology;
+		}
+
+		// nothing is stored per vertex, so every chunk starts at vertex 0
+		setGridUniforms(shader, chunk, 0);
+		topology->Draw(0);
+		indexCount += topology->indexCount;
+		drawnChunks++;
+		cacheBefore.Add(topology->cacheBefore);
+		cacheAfter.Add(topology->cacheAfter);
+	}
+	glBindVertexArray(0);
+}
+
+// Indices and chunks submitted by the last Draw
+std::size_t GpuSurface::IndexCount() const
+{
+	return indexCount;
+}
+
+std::size_t GpuSurface::DrawnChunks() const
+{
+	return drawnChunks;
+}
+
+// Vertex cache statistics of the chunks of the last Draw, before and after reordering
+void GpuSurface::CacheStats(VertexCacheStats& before, VertexCacheStats& after) const
+{
+	before = cacheBefore;
+	after = cacheAfter;
+}
+
+// Deletes the Vertex Array
+void GpuSurface::Delete()
+{
+	glDeleteVertexArrays(1, &VAO);
+}
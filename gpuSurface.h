@@ -0,0 +1,39 @@
+#ifndef GPU_SURFACE_H
+#define GPU_SURFACE_H
+
+#include<glad/glad.h>
+
+#include"frustum.h"
+#include"gridChunks.h"
+#include"gridTopology.h"
+#include"shaderClass.h"
+
+// Draws grid surfaces whose heights are evaluated in surface.vert. There is no vertex data,
+// the Vertex Array only holds the shared grid indices
+class GpuSurface
+{
+public:
+	// Reference ID of the Vertex Array
+	GLuint VAO;
+
+	// Constructor that generates the Vertex Array
+	GpuSurface();
+
+	// Draws the chunks of the grid that may be inside the frustum, every chunk when it is null, with the given shader,
+	// which must already be active and have its function uniforms set. The heights are unknown, so chunks are only culled along x and z
+	void Draw(Shader& shader, const ChunkedGrid& grid, GridLayout layout, GridTopologyRegistry& topologies, const Frustum* frustum);
+	// Indices and chunks submitted by the last Draw
+	std::size_t IndexCount() const;
+	std::size_t DrawnChunks() const;
+	// Vertex cache statistics of the chunks of the last Draw, before and after reordering
+	void CacheStats(VertexCacheStats& before, VertexCacheStats& after) const;
+	// Deletes the Vertex Array
+	void Delete();
+
+private:
+	std::size_t indexCount;
+	std::size_t drawnChunks;
+	VertexCacheStats cacheBefore;
+	VertexCacheStats cacheAfter;
+};
+#endif
@@ -0,0 +1,43 @@
+#include"gpuTimer.h"
+
+// Constructor that generates the queries
+GpuTimer::GpuTimer() : next(0), average(0.0)
+{
+	glGenQueries(GPU_TIMER_QUERIES, queries);
+	for (int i = 0; i < GPU_TIMER_QUERIES; i++)
+		issued[i] = false;
+}
+
+// Starts timing, only one GpuTimer can be running at a time
+void GpuTimer::Begin()
+{
+	// Collect the result this query held last time round before reusing it
+	if (issued[next])
+	{
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[next], GL_QUERY_RESULT, &nanoseconds);
+		average += (nanoseconds / 1.0e6 - average) * 0.1;
+		issued[next] = false;
+	}
+	glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+}
+
+// Stops timing
+void GpuTimer::End()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	issued[next] = true;
+	next = (next + 1) % GPU_TIMER_QUERIES;
+}
+
+// Smoothed GPU time of the timed commands in milliseconds
+double GpuTimer::Milliseconds() const
+{
+	return average;
+}
+
+// Deletes the queries
+void GpuTimer::Delete()
+{
+	glDeleteQueries(GPU_TIMER_QUERIES, queries);
+}
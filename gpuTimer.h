@@ -0,0 +1,34 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include<glad/glad.h>
+
+// Queries in flight, results are read this many frames after they were issued
+const int GPU_TIMER_QUERIES = 4;
+
+// Measures the GPU time of the commands between Begin and End with GL_TIME_ELAPSED queries.
+// Each result is read a few frames later, when it is ready, so timing never stalls the pipeline
+class GpuTimer
+{
+public:
+	// Reference IDs of the queries
+	GLuint queries[GPU_TIMER_QUERIES];
+
+	// Constructor that generates the queries
+	GpuTimer();
+
+	// Starts timing, only one GpuTimer can be running at a time
+	void Begin();
+	// Stops timing
+	void End();
+	// Smoothed GPU time of the timed commands in milliseconds
+	double Milliseconds() const;
+	// Deletes the queries
+	void Delete();
+
+private:
+	int next;
+	bool issued[GPU_TIMER_QUERIES];
+	double average;
+};
+#endif
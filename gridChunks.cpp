@@ -0,0 +1,63 @@
+#include"gridChunks.h"
+
+#include<cmath>
+
+// Constructor for an empty grid
+ChunkedGrid::ChunkedGrid() : grid(), maxChunkVertices(0), vertexCount(0)
+{
+}
+
+// Constructor that cuts the grid into chunks of at most maxChunkVertices samples
+ChunkedGrid::ChunkedGrid(const GridSpec& grid, int maxChunkVertices) : grid(grid), maxChunkVertices(maxChunkVertices), vertexCount(0)
+{
+	if (grid.rows <= 0 || grid.cols <= 0)
+		return;
+
+	// Roughly square chunks, or whole rows when the grid is narrow enough
+	int side = (int)std::sqrt((double)maxChunkVertices);
+	int chunkCols = grid.cols < side ? grid.cols : (side > 2 ? side : 2);
+	int chunkRows = maxChunkVertices / chunkCols;
+	if (chunkRows < 2)
+		chunkRows = 2;
+	if (chunkRows > grid.rows)
+		chunkRows = grid.rows;
+
+	// Consecutive chunks start on the last row/column of the previous one
+	for (int firstRow = 0;; firstRow += chunkRows - 1)
+	{
+		int rows = (grid.rows - firstRow < chunkRows) ? grid.rows - firstRow : chunkRows;
+		for (int firstCol = 0;; firstCol += chunkCols - 1)
+		{
+			int cols = (grid.cols - firstCol < chunkCols) ? grid.cols - firstCol : chunkCols;
+
+			GridSpec chunk = grid;
+			chunk.firstRow = grid.firstRow + firstRow;
+			chunk.firstCol = grid.firstCol + firstCol;
+			chunk.rows = rows;
+			chunk.cols = cols;
+			chunks.push_back(chunk);
+			offsets.push_back(vertexCount);
+			vertexCount += chunk.SampleCount();
+
+			int blockRows = GRID_BLOCK_SAMPLES / cols;
+			if (blockRows < 1)
+				blockRows = 1;
+			for (int row = 0; row < rows; row += blockRows)
+			{
+				ChunkRowBlock block = { (int)chunks.size() - 1, row, (rows - row < blockRows) ? rows : row + blockRows };
+				blocks.push_back(block);
+			}
+
+			if (firstCol + cols >= grid.cols)
+				break;
+		}
+		if (firstRow + rows >= grid.rows)
+			break;
+	}
+}
+
+// Returns true when both were cut from the same grid with the same limit
+bool ChunkedGrid::SameLayout(const ChunkedGrid& other) const
+{
+	return grid == other.grid && maxChunkVertices == other.maxChunkVertices;
+}
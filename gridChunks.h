@@ -0,0 +1,80 @@
+#ifndef GRID_CHUNKS_H
+#define GRID_CHUNKS_H
+
+#include<cstddef>
+#include<mutex>
+#include<vector>
+
+#include"gridMesher.h"
+#include"threadPool.h"
+
+// Most vertices in one chunk, MAX_SHORT_INDEX_VERTICES of gridTopology.h. Every chunk can be indexed
+// with 16 bits and the shared index buffer of a chunk size stays small whatever the grid size
+const int GRID_CHUNK_VERTICES = 65535;
+
+// Rows [firstRow, lastRow) of one chunk, the unit of work handed to a thread
+struct ChunkRowBlock
+{
+	int chunk;
+	int firstRow;
+	int lastRow;
+};
+
+// A grid split into rectangular chunks of at most maxChunkVertices samples. Neighbouring chunks
+// share their edge samples so the surface has no gaps, and the vertices of each chunk are stored
+// together, one chunk after another
+class ChunkedGrid
+{
+public:
+	// The whole grid
+	GridSpec grid;
+	// Limit the chunks were cut to
+	int maxChunkVertices;
+	// Chunks in storage order, each one a GridSpec with its own firstRow and firstCol
+	std::vector<GridSpec> chunks;
+	// Index of the first vertex of each chunk
+	std::vector<std::size_t> offsets;
+	// Vertices of all the chunks together
+	std::size_t vertexCount;
+	// Blocks of about GRID_BLOCK_SAMPLES samples covering every chunk, so a single ParallelFor
+	// keeps all the threads busy however few rows one chunk has
+	std::vector<ChunkRowBlock> blocks;
+
+	// Constructor for an empty grid
+	ChunkedGrid();
+	// Constructor that cuts the grid into chunks of at most maxChunkVertices samples
+	ChunkedGrid(const GridSpec& grid, int maxChunkVertices);
+
+	// Returns true when both were cut from the same grid with the same limit
+	bool SameLayout(const ChunkedGrid& other) const;
+};
+
+// Samples heightFn over every chunk of grid with one ParallelFor over all the row blocks. Writes the heights
+// and packed normals of each chunk at its offset, the height bounds of each chunk into chunkBounds,
+// and returns those of the whole grid
+template <typename HeightFn>
+HeightBounds buildChunkedGrid(const ChunkedGrid& grid, const HeightFn& heightFn, float* heights, uint32_t* normals, HeightBounds* chunkBounds, ThreadPool& threads)
+{
+	GridMesher<HeightFn> mesher(heightFn);
+	for (std::size_t i = 0; i < grid.chunks.size(); i++)
+		chunkBounds[i] = HeightBounds::Empty();
+
+	std::mutex boundsMutex;
+	threads.ParallelFor((int)grid.blocks.size(), 1, [&](int begin, int end)
+	{
+		for (int b = begin; b < end; b++)
+		{
+			const ChunkRowBlock& block = grid.blocks[b];
+			std::size_t offset = grid.offsets[block.chunk];
+			HeightBounds blockBounds = mesher.BuildRows(grid.chunks[block.chunk], block.firstRow, block.lastRow, heights + offset, normals + offset);
+			std::lock_guard<std::mutex> lock(boundsMutex);
+			chunkBounds[block.chunk].Merge(blockBounds);
+		}
+	});
+
+	HeightBounds bounds = HeightBounds::Empty();
+	for (std::size_t i = 0; i < grid.chunks.size(); i++)
+		bounds.Merge(chunkBounds[i]);
+	return bounds;
+}
+#endif
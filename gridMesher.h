@@ -0,0 +1,102 @@
+#ifndef GRID_MESHER_H
+#define GRID_MESHER_H
+
+#include<cstddef>
+#include<cstring>
+#include<vector>
+
+#include"surfaceKernels.h"
+
+// Rough number of samples handed to a thread at a time
+const int GRID_BLOCK_SAMPLES = 16384;
+
+// Regular sampling grid: rows run along x, columns along z
+struct GridSpec
+{
+	// Position of sample (0, 0) of the whole grid
+	float originX;
+	float originZ;
+	// Distance between neighbouring samples
+	float step;
+	int rows;
+	int cols;
+	// Index of the first row and column when this is a chunk of a larger grid. Sample (row, col)
+	// lies at origin + (first + index) * step so chunks land on exactly the same positions as the whole grid
+	int firstRow;
+	int firstCol;
+
+	// Number of samples, one height each
+	std::size_t SampleCount() const
+	{
+		return (std::size_t)rows * cols;
+	}
+};
+
+inline bool operator==(const GridSpec& a, const GridSpec& b)
+{
+	return a.originX == b.originX && a.originZ == b.originZ && a.step == b.step
+		&& a.rows == b.rows && a.cols == b.cols && a.firstRow == b.firstRow && a.firstCol == b.firstCol;
+}
+
+inline bool operator!=(const GridSpec& a, const GridSpec& b)
+{
+	return !(a == b);
+}
+
+// Samples a height functor over a GridSpec. HeightFn is a template parameter so the
+// compiler can inline it into the sampling loop
+template <typename HeightFn>
+class GridMesher
+{
+public:
+	explicit GridMesher(const HeightFn& heightFn) : heightFn(heightFn) {}
+
+	// Writes the heights and normals of rows [firstRow, lastRow) and returns their bounds.
+	// Each row is evaluated once, with one extra sample on both sides, into a window of three rows,
+	// so the normals of a row come from its neighbours while they are still in cache. Only the rows
+	// just outside the block, or outside the grid, are evaluated twice, which keeps chunk seams identical
+	HeightBounds BuildRows(const GridSpec& grid, int firstRow, int lastRow, float* heights, uint32_t* normals) const
+	{
+		HeightBounds bounds = HeightBounds::Empty();
+		std::size_t width = (std::size_t)grid.cols + 2;
+		// kept per thread so steady state rebuilds do not allocate
+		thread_local std::vector<float> window;
+		if (window.size() < width * 3)
+			window.resize(width * 3);
+		float* above = window.data() + 1;
+		float* row = above + width;
+		float* below = row + width;
+
+		EvaluateRow(grid, firstRow - 1, above);
+		EvaluateRow(grid, firstRow, row);
+		for (int r = firstRow; r < lastRow; r++)
+		{
+			EvaluateRow(grid, r + 1, below);
+
+			float* out = heights + (std::size_t)r * grid.cols;
+			std::memcpy(out, row, grid.cols * sizeof(float));
+			// the row is still in cache, so the bounds and normals cost no extra pass over memory
+			accumulateBounds(out, grid.cols, bounds);
+			slopeNormals(above, row, below, grid.cols, grid.step, normals + (std::size_t)r * grid.cols);
+
+			float* oldest = above;
+			above = row;
+			row = below;
+			below = oldest;
+		}
+		return bounds;
+	}
+
+private:
+	// Evaluates row (which may lie just outside the grid) at columns -1 to grid.cols into out[-1, grid.cols]
+	void EvaluateRow(const GridSpec& grid, int row, float* out) const
+	{
+		// x is computed from the sample index so no error accumulates along the grid
+		const float x = grid.originX + (grid.firstRow + row) * grid.step;
+		// batches from a SIMD kernel where the functor has one
+		evaluateRow(heightFn, x, grid.originZ, grid.step, grid.firstCol - 1, grid.cols + 2, out - 1);
+	}
+
+	HeightFn heightFn;
+};
+#endif
@@ -0,0 +1,152 @@
+#include"gridTopology.h"
+
+// Writes two triangles per cell of a rows x cols grid, returns the end of the written indices
+template <typename Index>
+static Index* writeGridTriangles(int rows, int cols, Index* out)
+{
+	for (int row = 0; row < rows - 1; row++)
+	{
+		for (int col = 0; col < cols - 1; col++)
+		{
+			Index topLeft = (Index)(row * cols + col);
+			Index topRight = (Index)(topLeft + 1);
+			Index bottomLeft = (Index)((row + 1) * cols + col);
+			Index bottomRight = (Index)(bottomLeft + 1);
+
+			*out++ = topLeft;
+			*out++ = bottomLeft;
+			*out++ = topRight;
+
+			*out++ = topRight;
+			*out++ = bottomLeft;
+			*out++ = bottomRight;
+		}
+	}
+	return out;
+}
+
+// Writes one strip per pair of rows, alternating between the top and bottom row so the
+// triangles match the list layout, with a restart index between strips
+template <typename Index>
+static Index* writeGridStrips(int rows, int cols, Index restart, Index* out)
+{
+	for (int row = 0; row < rows - 1; row++)
+	{
+		if (row > 0)
+			*out++ = restart;
+		for (int col = 0; col < cols; col++)
+		{
+			*out++ = (Index)(row * cols + col);
+			*out++ = (Index)((row + 1) * cols + col);
+		}
+	}
+	return out;
+}
+
+// Writes the indices of the layout and measures their vertex cache behaviour
+template <typename Index>
+static void writeGridIndices(int rows, int cols, GridLayout layout, Index* out, std::size_t count, GridTopology& topology, FrameArena& scratch)
+{
+	if (layout == TRIANGLE_STRIP)
+	{
+		writeGridStrips(rows, cols, (Index)~(Index)0, out);
+		return;
+	}
+
+	std::size_t vertexCount = (std::size_t)rows * cols;
+	writeGridTriangles(rows, cols, out);
+	topology.cacheBefore = measureVertexCache(out, count, vertexCount, scratch);
+	topology.cacheAfter = topology.cacheBefore;
+	if (layout == OPTIMIZED_LIST)
+	{
+		optimizeVertexCache(out, count, vertexCount, scratch);
+		topology.cacheAfter = measureVertexCache(out, count, vertexCount, scratch);
+	}
+}
+
+// Constructor that builds the indices in scratch memory and uploads them once
+GridTopology::GridTopology(int rows, int cols, GridLayout layout, FrameArena& scratch) : rows(rows), cols(cols)
+{
+	std::size_t count = 0;
+	if (rows > 1 && cols > 1)
+	{
+		if (layout == TRIANGLE_STRIP)
+			count = (std::size_t)(rows - 1) * cols * 2 + (rows - 2);
+		else
+			count = (std::size_t)(rows - 1) * (cols - 1) * 6;
+	}
+	indexCount = (GLsizei)count;
+	mode = (layout == TRIANGLE_STRIP) ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+	cacheBefore = VertexCacheStats();
+	cacheAfter = VertexCacheStats();
+
+	// Half the index memory and bandwidth whenever every vertex can be addressed with 16 bits
+	void* indices;
+	if ((std::size_t)rows * cols <= MAX_SHORT_INDEX_VERTICES)
+	{
+		indexType = GL_UNSIGNED_SHORT;
+		indexSize = sizeof(unsigned short);
+		restartIndex = 0xFFFF;
+		indices = scratch.Allocate<unsigned short>(count);
+		writeGridIndices(rows, cols, layout, (unsigned short*)indices, count, *this, scratch);
+	}
+	else
+	{
+		indexType = GL_UNSIGNED_INT;
+		indexSize = sizeof(unsigned int);
+		restartIndex = 0xFFFFFFFF;
+		indices = scratch.Allocate<unsigned int>(count);
+		writeGridIndices(rows, cols, layout, (unsigned int*)indices, count, *this, scratch);
+	}
+
+	// Unbind any Vertex Array so it does not pick up this Element Buffer, then restore it
+	// since topologies get created lazily in the middle of drawing
+	GLint previousVAO = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVAO);
+	glBindVertexArray(0);
+	glGenBuffers(1, &EBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * indexSize, indices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glBindVertexArray((GLuint)previousVAO);
+}
+
+// Draws the grid from the Vertex Array currently bound, with its first vertex at baseVertex
+void GridTopology::Draw(GLint baseVertex) const
+{
+	// GL_PRIMITIVE_RESTART is enabled once at startup, only the index depends on the index type
+	if (mode == GL_TRIANGLE_STRIP)
+		glPrimitiveRestartIndex(restartIndex);
+	glDrawElementsBaseVertex(mode, indexCount, indexType, 0, baseVertex);
+}
+
+// Deletes the Element Buffer
+void GridTopology::Delete()
+{
+	glDeleteBuffers(1, &EBO);
+}
+
+// Returns the topology for the given grid size, building it the first time it is requested
+const GridTopology& GridTopologyRegistry::Get(int rows, int cols, GridLayout layout)
+{
+	std::map<std::pair<int, int>, GridTopology>& sizes = topologies[layout];
+	std::pair<int, int> size(rows, cols);
+	std::map<std::pair<int, int>, GridTopology>::iterator it = sizes.find(size);
+	if (it == sizes.end())
+	{
+		scratch.Reset();
+		it = sizes.insert(std::make_pair(size, GridTopology(rows, cols, layout, scratch))).first;
+	}
+	return it->second;
+}
+
+// Deletes the Element Buffers of every topology
+void GridTopologyRegistry::Delete()
+{
+	for (int layout = 0; layout < GRID_LAYOUT_COUNT; layout++)
+	{
+		for (std::map<std::pair<int, int>, GridTopology>::iterator it = topologies[layout].begin(); it != topologies[layout].end(); ++it)
+			it->second.Delete();
+		topologies[layout].clear();
+	}
+}
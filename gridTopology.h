@@ -0,0 +1,72 @@
+#ifndef GRID_TOPOLOGY_H
+#define GRID_TOPOLOGY_H
+
+#include<glad/glad.h>
+#include<cstddef>
+#include<map>
+#include<utility>
+
+#include"frameArena.h"
+#include"vertexCache.h"
+
+// Most vertices a grid can have and still be indexed with GL_UNSIGNED_SHORT. Index 65535 is
+// left out because it is the primitive restart index of 16-bit strips
+const std::size_t MAX_SHORT_INDEX_VERTICES = 65535;
+
+// How the triangles of a grid are listed
+enum GridLayout
+{
+	// 6 indices per cell drawn as GL_TRIANGLES
+	TRIANGLE_LIST,
+	// one GL_TRIANGLE_STRIP per pair of rows, separated by the primitive restart index
+	TRIANGLE_STRIP,
+	// the triangle list reordered for the post-transform vertex cache, built once per grid size
+	OPTIMIZED_LIST,
+	GRID_LAYOUT_COUNT
+};
+
+// Triangle indices of a rows x cols grid of vertices stored row by row
+class GridTopology
+{
+public:
+	// Reference ID of the Element Buffer holding the indices
+	GLuint EBO;
+	// Number of indices in the Element Buffer
+	GLsizei indexCount;
+	// GL_UNSIGNED_SHORT for grids of at most MAX_SHORT_INDEX_VERTICES vertices, GL_UNSIGNED_INT otherwise
+	GLenum indexType;
+	std::size_t indexSize;
+	// GL_TRIANGLES or GL_TRIANGLE_STRIP, and the index that restarts a strip
+	GLenum mode;
+	GLuint restartIndex;
+	// Simulated vertex cache behaviour of the row by row triangle list and of the indices actually
+	// stored, no triangles are counted for strips
+	VertexCacheStats cacheBefore;
+	VertexCacheStats cacheAfter;
+	int rows;
+	int cols;
+
+	// Constructor that builds the indices in scratch memory and uploads them once
+	GridTopology(int rows, int cols, GridLayout layout, FrameArena& scratch);
+
+	// Draws the grid from the Vertex Array currently bound, with its first vertex at baseVertex
+	void Draw(GLint baseVertex) const;
+	// Deletes the Element Buffer
+	void Delete();
+};
+
+// Keeps one resident GridTopology per grid size and layout so every surface of that size shares it
+class GridTopologyRegistry
+{
+public:
+	// Returns the topology for the given grid size, building it the first time it is requested
+	const GridTopology& Get(int rows, int cols, GridLayout layout);
+	// Deletes the Element Buffers of every topology
+	void Delete();
+
+private:
+	std::map<std::pair<int, int>, GridTopology> topologies[GRID_LAYOUT_COUNT];
+	// Holds the indices of a topology until they are uploaded
+	FrameArena scratch;
+};
+#endif
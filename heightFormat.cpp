@@ -0,0 +1,117 @@
+#include"heightFormat.h"
+
+#include<cmath>
+#include<cstring>
+#include<stdint.h>
+
+// Rough number of heights converted by a thread at a time
+static const int ENCODE_BLOCK_HEIGHTS = 16384;
+
+// Bytes per height of the format
+std::size_t heightSize(HeightFormat format)
+{
+	return format == HEIGHT_FLOAT ? sizeof(float) : sizeof(uint16_t);
+}
+
+// Encoding of heights within bounds. Falls back to HEIGHT_FLOAT when the bounds are not finite
+HeightEncoding encodeHeightsAs(HeightFormat format, const HeightBounds& bounds)
+{
+	HeightEncoding encoding = { format, 1.0f, 0.0f };
+	if (format == HEIGHT_UNORM16)
+	{
+		if (bounds.IsEmpty() || !std::isfinite(bounds.min) || !std::isfinite(bounds.max) || !std::isfinite(bounds.max - bounds.min))
+			encoding.format = HEIGHT_FLOAT;
+		else
+		{
+			// 0 maps to the lowest height and 65534 to the highest, 65535 is HEIGHT_UNORM16_MISSING
+			encoding.scale = (bounds.max - bounds.min) * (65535.0f / 65534.0f);
+			encoding.bias = bounds.min;
+		}
+	}
+	return encoding;
+}
+
+// Rounds to the nearest half float, ties to even, with overflow going to infinity
+static uint16_t floatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t magnitude = bits & 0x7FFFFFFF;
+
+	// infinity and NaN, keeping NaN a NaN
+	if (magnitude >= 0x7F800000)
+		return (uint16_t)(sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0));
+	// 65520 and up round past the largest half
+	if (magnitude >= 0x477FF000)
+		return (uint16_t)(sign | 0x7C00);
+	// below 2^-14 the result is subnormal, and below 2^-25 it rounds to zero
+	if (magnitude < 0x38800000)
+	{
+		if (magnitude < 0x33000000)
+			return (uint16_t)sign;
+		uint32_t shift = 126 - (magnitude >> 23);
+		uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+		uint32_t half = mantissa >> shift;
+		uint32_t rest = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if (rest > halfway || (rest == halfway && (half & 1)))
+			half++;
+		return (uint16_t)(sign | half);
+	}
+
+	// rebias the exponent from 127 to 15 and drop 13 mantissa bits, a carry moves into the exponent
+	uint32_t half = (magnitude - 0x38000000) >> 13;
+	uint32_t rest = magnitude & 0x1FFF;
+	if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+		half++;
+	return (uint16_t)(sign | half);
+}
+
+// Converts count float heights to the encoding and writes them to out
+void encodeHeights(const float* heights, std::size_t count, const HeightEncoding& encoding, void* out, ThreadPool& threads)
+{
+	if (encoding.format == HEIGHT_FLOAT)
+	{
+		std::memcpy(out, heights, count * sizeof(float));
+		return;
+	}
+
+	uint16_t* encoded = (uint16_t*)out;
+	const float inverseScale = encoding.scale > 0.0f ? 65535.0f / encoding.scale : 0.0f;
+	threads.ParallelFor((int)count, ENCODE_BLOCK_HEIGHTS, [&](int begin, int end)
+	{
+		if (encoding.format == HEIGHT_HALF)
+		{
+			for (int i = begin; i < end; i++)
+				encoded[i] = floatToHalf(heights[i]);
+			return;
+		}
+		for (int i = begin; i < end; i++)
+		{
+			float q = (heights[i] - encoding.bias) * inverseScale + 0.5f;
+			if (std::isnan(q))
+				encoded[i] = HEIGHT_UNORM16_MISSING;
+			else
+				encoded[i] = (q > 0.0f) ? ((q < 65534.0f) ? (uint16_t)q : (uint16_t)65534) : (uint16_t)0;
+		}
+	});
+}
+
+// Points vertex attribute 1 at tightly packed heights of the format in the bound Vertex Buffer, starting offset bytes in
+void setHeightAttribute(HeightFormat format, std::size_t offset)
+{
+	if (format == HEIGHT_HALF)
+		glVertexAttribPointer(1, 1, GL_HALF_FLOAT, GL_FALSE, sizeof(uint16_t), (void*)offset);
+	else if (format == HEIGHT_UNORM16)
+		glVertexAttribPointer(1, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(uint16_t), (void*)offset);
+	else
+		glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)offset);
+}
+
+// Points vertex attribute 2 at tightly packed normals in the bound Vertex Buffer, starting offset bytes in
+void setNormalAttribute(std::size_t offset)
+{
+	// Signed normalized, so the shader reads components in [-1, 1]
+	glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, (GLsizei)NORMAL_SIZE, (void*)offset);
+}
@@ -0,0 +1,48 @@
+#ifndef HEIGHT_FORMAT_H
+#define HEIGHT_FORMAT_H
+
+#include<glad/glad.h>
+#include<cstddef>
+
+#include"surfaceKernels.h"
+#include"threadPool.h"
+
+// How grid heights are stored in the Vertex Buffer
+enum HeightFormat
+{
+	// 32-bit float, 4 bytes per vertex
+	HEIGHT_FLOAT,
+	// 16-bit half float, 2 bytes per vertex
+	HEIGHT_HALF,
+	// 16-bit normalized integer spanning the mesh's bounds, 2 bytes per vertex
+	HEIGHT_UNORM16,
+	HEIGHT_FORMAT_COUNT
+};
+
+// HEIGHT_UNORM16 value of NaN samples. Heights use 0 to 65534, default.vert and default.frag leave out the
+// triangles around this one, as happens to a NaN position in the float formats
+const uint16_t HEIGHT_UNORM16_MISSING = 65535;
+
+// Format of an uploaded set of heights and the scale and bias default.vert applies to get them back:
+// height = attribute * scale + bias
+struct HeightEncoding
+{
+	HeightFormat format;
+	float scale;
+	float bias;
+};
+
+// Bytes per height of the format
+std::size_t heightSize(HeightFormat format);
+// Encoding of heights within bounds. Falls back to HEIGHT_FLOAT when the bounds are not finite
+HeightEncoding encodeHeightsAs(HeightFormat format, const HeightBounds& bounds);
+// Converts count float heights to the encoding and writes them to out
+void encodeHeights(const float* heights, std::size_t count, const HeightEncoding& encoding, void* out, ThreadPool& threads);
+// Points vertex attribute 1 at tightly packed heights of the format in the bound Vertex Buffer, starting offset bytes in
+void setHeightAttribute(HeightFormat format, std::size_t offset);
+
+// Bytes per normal, packed as GL_INT_2_10_10_10_REV by packNormal
+const std::size_t NORMAL_SIZE = 4;
+// Points vertex attribute 2 at tightly packed normals in the bound Vertex Buffer, starting offset bytes in
+void setNormalAttribute(std::size_t offset);
+#endif
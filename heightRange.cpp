@@ -0,0 +1,53 @@
+#include"heightRange.h"
+
+#include<cstring>
+
+// Maps a float to an unsigned integer with the same order, like orderedBits in surface.comp
+uint32_t orderedBits(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+}
+
+// Constructor that generates the buffer, empty, and binds it at HEIGHT_RANGE_BINDING
+HeightRange::HeightRange()
+{
+	// Padded to a whole vec4, which some drivers round uniform blocks up to
+	glGenBuffers(1, &UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, 4 * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, HEIGHT_RANGE_BINDING, UBO);
+	Reset();
+}
+
+// Uploads bounds computed on the CPU
+void HeightRange::Update(const HeightBounds& bounds)
+{
+	if (bounds.IsEmpty())
+	{
+		Reset();
+		return;
+	}
+	const GLuint range[2] = { orderedBits(bounds.min), orderedBits(bounds.max) };
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(range), range);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Marks the range as unknown, the shaders then fall back to a fixed scale
+void HeightRange::Reset()
+{
+	// The same empty range surface.comp starts its reduction from
+	const GLuint emptyRange[2] = { 0xFFFFFFFFu, 0u };
+	glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(emptyRange), emptyRange);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// Deletes the buffer
+void HeightRange::Delete()
+{
+	glDeleteBuffers(1, &UBO);
+}
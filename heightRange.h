@@ -0,0 +1,36 @@
+#ifndef HEIGHT_RANGE_H
+#define HEIGHT_RANGE_H
+
+#include<glad/glad.h>
+#include<stdint.h>
+
+#include"surfaceKernels.h"
+
+// Uniform buffer binding point of the HeightRange the colormap is normalized by
+const GLuint HEIGHT_RANGE_BINDING = 1;
+// Name of the uniform block in the shaders
+const char* const HEIGHT_RANGE_NAME = "HeightRange";
+
+// Maps a float to an unsigned integer with the same order, like orderedBits in surface.comp
+uint32_t orderedBits(float value);
+
+// Uniform buffer holding the height range of the plotted surface as two order preserving integers,
+// minimum then maximum. The CPU generators upload the bounds they reduced while building the rows,
+// surface.comp reduces into it with atomics, so the range never needs a pass of its own
+class HeightRange
+{
+public:
+	// Reference ID of the Uniform Buffer Object
+	GLuint UBO;
+
+	// Constructor that generates the buffer, empty, and binds it at HEIGHT_RANGE_BINDING
+	HeightRange();
+
+	// Uploads bounds computed on the CPU
+	void Update(const HeightBounds& bounds);
+	// Marks the range as unknown, the shaders then fall back to a fixed scale
+	void Reset();
+	// Deletes the buffer
+	void Delete();
+};
+#endif
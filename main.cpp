@@ -7,7 +7,11 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <vector>
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -15,6 +19,26 @@
 
 #include "shaderClass.h"
 #include "camera.h"
+#include "cameraBlock.h"
+#include "clipmap.h"
+#include "colormap.h"
+#include "computeSurface.h"
+#include "feedbackSurface.h"
+#include "frameArena.h"
+#include "frustum.h"
+#include "glExtensions.h"
+#include "gpuSurface.h"
+#include "gpuTimer.h"
+#include "gridChunks.h"
+#include "gridMesher.h"
+#include "gridTopology.h"
+#include "heightFormat.h"
+#include "heightRange.h"
+#include "programCache.h"
+#include "surfaceFunctions.h"
+#include "surfaceMesh.h"
+#include "threadPool.h"
+#include "timeBasis.h"
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_callback(GLFWwindow *window, double xposIn, double yposIn);
@@ -27,6 +51,9 @@ const unsigned int SCR_HEIGHT = 800;
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+// framebuffer size, kept up to date by framebuffer_size_callback
+int viewportWidth = SCR_WIDTH;
+int viewportHeight = SCR_HEIGHT;
 float lastX = SCR_WIDTH / 2.0f;
 float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
@@ -36,7 +63,10 @@ float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
 // Constants
-int GRID_SIZE = 20;
+int GRID_SIZE = 20;            // grid extent, functions are sampled over [-GRID_SIZE, GRID_SIZE)
+int GRID_SAMPLES = 40;         // samples along each axis of the grid
+const int MAX_GRID_SIZE = 10000;
+const int MAX_GRID_SAMPLES = 20000; // 400 million samples at most
 float wave_amplitude = 25.0f;  // sombrero amplitude
 float wave_length = 2.0f;      // sombrero wavelength
 float ripple_Strength = 2.5;   // ripple strength
@@ -50,44 +80,200 @@ float letterO_size = 5;        // size of letter O
 float top_hat_height = 0.25;   // height of top hat function
 float bump_height = 0.2;       // height of the bump function
 int choice = 1;                // to chose which graph to display
+GridLayout gridLayout = TRIANGLE_LIST; // index layout, set with --strips, --optimized or from the controls window
+HeightFormat heightFormat = HEIGHT_FLOAT; // storage of grid heights, set with --heights or from the controls window
+SurfaceGenerator surfaceGenerator = GENERATE_CPU; // where plotted meshes are generated, set with --feedback, --compute or from the controls window
+ColormapKind colormapKind = COLORMAP_VIRIDIS; // colours of the heights, set with --colormap or from the controls window
+const int TORUS_ROWS = 20;     // rings of the torus
+const int TORUS_COLS = 40;     // samples around each ring
+
+// threads evaluating the mesh, set with --threads or from the controls window
+ThreadPool meshThreads;
+int meshThreadCount = 1;
+
+// Cores of the machine, hardware_concurrency may not know and return 0
+int hardwareThreads()
+{
+    int count = (int)std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+// scratch memory of a mesh rebuild, reset at the start of every rebuild
+FrameArena meshArena;
+// sin/cos of the ripple phase over the current grid, so an animation frame is a linear combination
+TimeBasis rippleBasis;
+
+// The ripple is animated and regenerated every frame
+bool isAnimated(int surfaceChoice)
+{
+    return surfaceChoice == 2;
+}
+
+// Collects everything the plotted mesh depends on
+SurfaceKey currentSurfaceKey()
+{
+    SurfaceKey key = {};
+    key.choice = choice;
+    key.gridSize = GRID_SIZE;
+    key.samples = GRID_SAMPLES;
+    key.layout = gridLayout;
+    key.heightFormat = heightFormat;
+    key.generator = surfaceGenerator;
+    // animated surfaces have to be regenerated every frame
+    key.time = isAnimated(choice) ? glfwGetTime() : 0.0;
+
+    const float params[SURFACE_PARAM_COUNT] = {
+        wave_amplitude, wave_length, ripple_Strength, ripple_frequency, radius_to_center, tube_radius,
+        fence_height, stair_distance, letterO_height, letterO_size, top_hat_height, bump_height};
+    for (int i = 0; i < SURFACE_PARAM_COUNT; i++)
+        key.params[i] = params[i];
+    return key;
+}
 
-float calculateHeight(float x, float y)
+// Builds the heights and packed normals of one grid-based function into preallocated arrays, chunk after chunk,
+// writes the height bounds of every chunk into chunkBounds and returns those of the whole grid
+typedef HeightBounds (*GridBuilder)(const SurfaceKey &key, const ChunkedGrid &grid, float *heights, uint32_t *normals, HeightBounds *chunkBounds);
+
+template <typename HeightFn>
+HeightBounds buildGrid(const ChunkedGrid &grid, const HeightFn &heightFn, float *heights, uint32_t *normals, HeightBounds *chunkBounds)
+{
+    return buildChunkedGrid(grid, heightFn, heights, normals, chunkBounds, meshThreads);
+}
+HeightBounds buildSombrero(const SurfaceKey &, const ChunkedGrid &grid, float *heights, uint32_t *normals, HeightBounds *chunkBounds)
+{
+    Sombrero heightFn = {wave_amplitude, wave_length};
+    return buildGrid(grid, heightFn, heights, normals, chunkBounds);
+}
+HeightBounds buildRipple(const SurfaceKey &key, const ChunkedGrid &grid, float *heights, uint32_t *normals, HeightBounds *chunkBounds)
 {
-    float r = std::sqrt(x * x + y * y);
-    return wave_amplitude * (std::sin(r / wave_length) / (r / wave_length));
+    // the phase only depends on the grid, a new frame just reweights the cached bases
+    if (!rippleBasis.Matches(grid))
+        rippleBasis.Build(grid, RipplePhase(), meshThreads);
+    HeightBounds bounds = rippleBasis.Evaluate(ripple_Strength, key.time * ripple_frequency, heights, normals, meshThreads);
+    // the bases are combined over the whole grid at once, every chunk gets the bounds of all of them
+    for (std::size_t i = 0; i < grid.chunks.size(); i++)
+        chunkBounds[i] = bounds;
+    return bounds;
 }
-float calculateRipple(float x, float y)
+HeightBounds buildFences(const SurfaceKey &, const ChunkedGrid &grid, float *heights, uint32_t *normals, HeightBounds *chunkBounds)
 {
-    return ripple_Strength * sin(glfwGetTime() * ripple_frequency + x / 5 + y / 5);
+    IntersectingFences heightFn = {fence_height};
+    return buildGrid(grid, heightFn, heights, normals, chunkBounds);
 }
-float calculateTorus(float x, float z)
+HeightBounds buildStairs(const SurfaceKey &, const ChunkedGrid &grid, float *heights, uint32_t *normals, HeightBounds *chunkBounds)
 {
-    return sqrt(pow(tube_radius, 2) - pow(radius_to_center - sqrt(pow(x, 2) + pow(z, 2)), 2));
+    Stairs heightFn = {stair_distance};
+    return buildGrid(grid, heightFn, heights, normals, chunkBounds);
 }
-float intersectingFences(float x, float y)
+HeightBounds buildLetterO(const SurfaceKey &, const ChunkedGrid &grid, float *heights, uint32_t *normals, HeightBounds *chunkBounds)
 {
-    return fence_height / exp(pow((x * 5), 2) * pow((y * 5), 2));
+    LetterO heightFn = {letterO_height, letterO_size};
+    return buildGrid(grid, heightFn, heights, normals, chunkBounds);
 }
-float sign(float v) // signum function
+HeightBounds buildTopHat(const SurfaceKey &, const ChunkedGrid &grid, float *heights, uint32_t *normals, HeightBounds *chunkBounds)
 {
-    return (v < 0) ? -1 : ((v > 0) ? 1 : 0);
+    TopHat heightFn = {top_hat_height};
+    return buildGrid(grid, heightFn, heights, normals, chunkBounds);
 }
-float stairs(float x, float y)
+HeightBounds buildBumps(const SurfaceKey &, const ChunkedGrid &grid, float *heights, uint32_t *normals, HeightBounds *chunkBounds)
 {
-    return sign(x - stair_distance + abs(y * 2)) / .5 + sign(x - .5 + abs(y * 2)) / 1;
+    Bumps heightFn = {bump_height};
+    return buildGrid(grid, heightFn, heights, normals, chunkBounds);
 }
-float letterO(float x, float y)
+
+// Grid-based functions indexed by choice; the torus (3) is parametric and built by buildTorus
+const GridBuilder gridBuilders[] = {
+    nullptr, buildSombrero, buildRipple, nullptr, buildFences, buildStairs, buildLetterO, buildTopHat, buildBumps};
+
+// Writes the torus rings into preallocated arrays of rows x cols positions and packed normals,
+// and returns the bounds of their heights
+HeightBounds buildTorus(int rows, int cols, float *vertices, uint32_t *normals)
 {
-    return (-sign(20 - (pow(x, 2) + pow(y, 2))) + sign(20 - (pow(x, 2) / abs(letterO_size) + pow(y, 2) / abs(letterO_size)))) / abs(letterO_height);
+    HeightBounds bounds = HeightBounds::Empty();
+    for (int i = 0; i < rows; ++i)
+    {
+        float phi = 2.5f * glm::pi<float>() * static_cast<float>(i) / rows;
+        for (int j = 0; j < cols; ++j)
+        {
+            float theta = 2.0f * glm::pi<float>() * static_cast<float>(j) / cols;
+            float *out = vertices + (i * cols + j) * 3;
+
+            out[0] = (radius_to_center + tube_radius * std::cos(theta)) * std::cos(phi);
+            out[1] = tube_radius * std::sin(theta);
+            out[2] = (radius_to_center + tube_radius * std::cos(theta)) * std::sin(phi);
+            // the normal points away from the centre of the tube
+            normals[i * cols + j] = packNormal(std::cos(theta) * std::cos(phi), std::sin(theta), std::cos(theta) * std::sin(phi));
+            HeightBounds height = {out[1], out[1]};
+            bounds.Merge(height);
+        }
+    }
+    return bounds;
 }
-float topHat(float x, float y)
+
+// Sampling grid of the grid-based functions, cut into chunks again only when its size changes
+const ChunkedGrid &currentGrid()
 {
-    return (sign(20 - (pow(x, 2) + pow(y, 2))) + sign(20 - (pow(x, 2) / 3 + pow(y, 2) / 3))) / abs(top_hat_height) - 1;
+    static ChunkedGrid chunked;
+    float step = 2.0f * GRID_SIZE / GRID_SAMPLES;
+    GridSpec grid = {(float)-GRID_SIZE, (float)-GRID_SIZE, step, GRID_SAMPLES, GRID_SAMPLES, 0, 0};
+    if (chunked.chunks.empty() || chunked.grid != grid)
+        chunked = ChunkedGrid(grid, GRID_CHUNK_VERTICES);
+    return chunked;
 }
-float bumps(float x, float y)
+
+// Generates the function selected by the key, uploads it into the mesh and its height bounds into range.
+// The vertices come from meshArena, sized exactly, or for animated surfaces from the mesh's stream buffer,
+// so animating does not touch the heap
+void generateSurface(const SurfaceKey &key, SurfaceMesh &mesh, GridTopologyRegistry &topologies, HeightRange &range)
 {
-    return sin(6 * x) * cos(6 * y) / abs(bump_height);
+    meshArena.Reset();
+    if (key.choice == 3)
+    {
+        float *vertices = meshArena.Allocate<float>((std::size_t)TORUS_ROWS * TORUS_COLS * 3);
+        uint32_t *normals = meshArena.Allocate<uint32_t>((std::size_t)TORUS_ROWS * TORUS_COLS);
+        range.Update(buildTorus(TORUS_ROWS, TORUS_COLS, vertices, normals));
+        mesh.UploadPositions(key, vertices, normals, (std::size_t)TORUS_ROWS * TORUS_COLS, topologies.Get(TORUS_ROWS, TORUS_COLS, (GridLayout)key.layout));
+        return;
+    }
+
+    // grid-based functions only upload their heights, and the bounds of every chunk to cull it with
+    const ChunkedGrid &grid = currentGrid();
+    HeightBounds *chunkBounds = meshArena.Allocate<HeightBounds>(grid.chunks.size());
+    HeightFormat format = (HeightFormat)key.heightFormat;
+    if (isAnimated(key.choice) && format == HEIGHT_FLOAT)
+    {
+        // written straight into the persistently mapped stream buffers when the driver allows it
+        void *streamed = mesh.BeginStreamHeights(grid.vertexCount, HEIGHT_FLOAT);
+        uint32_t *streamedNormals = mesh.BeginStreamNormals(grid.vertexCount);
+        HeightBounds bounds = gridBuilders[key.choice](key, grid, (float *)streamed, streamedNormals, chunkBounds);
+        range.Update(bounds);
+        mesh.EndStreamHeights(key, encodeHeightsAs(HEIGHT_FLOAT, bounds), grid, chunkBounds, topologies);
+        return;
+    }
+
+    // compact formats need the bounds of the float heights before they can be encoded, normals are final straight away
+    bool animated = isAnimated(key.choice);
+    float *heights = meshArena.Allocate<float>(grid.vertexCount);
+    uint32_t *normals = animated ? mesh.BeginStreamNormals(grid.vertexCount) : meshArena.Allocate<uint32_t>(grid.vertexCount);
+    HeightBounds bounds = gridBuilders[key.choice](key, grid, heights, normals, chunkBounds);
+    range.Update(bounds);
+    HeightEncoding encoding = encodeHeightsAs(format, bounds);
+    if (animated)
+    {
+        void *streamed = mesh.BeginStreamHeights(grid.vertexCount, encoding.format);
+        encodeHeights(heights, grid.vertexCount, encoding, streamed, meshThreads);
+        mesh.EndStreamHeights(key, encoding, grid, chunkBounds, topologies);
+        return;
+    }
+    const void *encoded = heights;
+    if (encoding.format != HEIGHT_FLOAT)
+    {
+        void *packed = meshArena.Allocate<unsigned char>(grid.vertexCount * heightSize(encoding.format));
+        encodeHeights(heights, grid.vertexCount, encoding, packed, meshThreads);
+        encoded = packed;
+    }
+    mesh.UploadHeights(key, encoded, normals, encoding, grid, chunkBounds, topologies);
 }
+
 bool captureMouse = true;
 bool cameraControl = true;
 // define in order to toggle mouse caputere
@@ -108,11 +294,193 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
         cameraControl = captureMouse;
     }
 }
-// toggle wireframe Mode
-bool wireframeMode = true;
+// How default.frag draws the triangle edges, in the order of the Wireframe combo
+enum WireframeMode
+{
+    WIREFRAME_OFF,
+    // the edges alone, like the old glPolygonMode line mode
+    WIREFRAME_LINES,
+    // the edges over the lit surface, in the same draw
+    WIREFRAME_OVERLAY,
+    WIREFRAME_MODE_COUNT
+};
+WireframeMode wireframeMode = WIREFRAME_LINES;
+// evaluate grid-based functions in surface.vert instead of building a mesh
+bool gpuSurfaces = false;
+// skip the chunks of the surface outside the view
+bool frustumCulling = true;
+// plot grid-based functions with a geometry clipmap centred on the camera instead of the fixed grid
+bool clipmapMode = false;
+float clipmapStep = 0.25f; // spacing of the finest clipmap level, set with --clipmap-step or from the controls window
+int clipmapLevels = 10;    // nested clipmap levels, each doubling the extent
+
+// Clip planes of the fixed grids
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
+// The clipmap far plane reaches the corners of its coarsest level. The near plane keeps at most this far/near
+// ratio so the 24-bit depth buffer still separates the surface from itself (OpenGL 3.3 has no reversed Z)
+const float CLIPMAP_DEPTH_RATIO = 10000.0f;
+
+// Centres the clipmap on the camera and evaluates the samples its levels uncovered with the function of the key
+void updateClipmap(GeometryClipmap &clipmap, const SurfaceKey &key, const glm::vec3 &center)
+{
+    switch (key.choice)
+    {
+    case 1:
+    {
+        Sombrero heightFn = {wave_amplitude, wave_length};
+        clipmap.Update(key, heightFn, clipmapStep, clipmapLevels, center.x, center.z, meshThreads);
+        break;
+    }
+    case 2:
+    {
+        // the whole clipmap changes every frame, the time bases only pay off over a fixed grid
+        Ripple heightFn = {ripple_Strength, ripple_frequency, (float)key.time};
+        clipmap.Update(key, heightFn, clipmapStep, clipmapLevels, center.x, center.z, meshThreads);
+        break;
+    }
+    case 4:
+    {
+        IntersectingFences heightFn = {fence_height};
+        clipmap.Update(key, heightFn, clipmapStep, clipmapLevels, center.x, center.z, meshThreads);
+        break;
+    }
+    case 5:
+    {
+        Stairs heightFn = {stair_distance};
+        clipmap.Update(key, heightFn, clipmapStep, clipmapLevels, center.x, center.z, meshThreads);
+        break;
+    }
+    case 6:
+    {
+        LetterO heightFn = {letterO_height, letterO_size};
+        clipmap.Update(key, heightFn, clipmapStep, clipmapLevels, center.x, center.z, meshThreads);
+        break;
+    }
+    case 7:
+    {
+        TopHat heightFn = {top_hat_height};
+        clipmap.Update(key, heightFn, clipmapStep, clipmapLevels, center.x, center.z, meshThreads);
+        break;
+    }
+    default:
+    {
+        Bumps heightFn = {bump_height};
+        clipmap.Update(key, heightFn, clipmapStep, clipmapLevels, center.x, center.z, meshThreads);
+        break;
+    }
+    }
+}
+
+// Passes the plotted function and its parameters to surface.vert or surface.comp
+void setSurfaceParameters(Shader &shader, float time)
+{
+    shader.SetInt("surfaceChoice", choice);
+    shader.SetFloat("time", time);
+    shader.SetFloat("wave_amplitude", wave_amplitude);
+    shader.SetFloat("wave_length", wave_length);
+    shader.SetFloat("ripple_Strength", ripple_Strength);
+    shader.SetFloat("ripple_frequency", ripple_frequency);
+    shader.SetFloat("radius_to_center", radius_to_center);
+    shader.SetFloat("tube_radius", tube_radius);
+    shader.SetFloat("fence_height", fence_height);
+    shader.SetFloat("stair_distance", stair_distance);
+    shader.SetFloat("letterO_height", letterO_height);
+    shader.SetFloat("letterO_size", letterO_size);
+    shader.SetFloat("top_hat_height", top_hat_height);
+    shader.SetFloat("bump_height", bump_height);
+}
 
-int main()
+// Generates the function selected by the key on the GPU straight into the Vertex and Normal Buffers of the mesh, with a
+// ComputeSurface or a FeedbackSurface and the program of the generator for the key. Heights are always stored as floats,
+// there is no upload for the compact formats to save. surface.comp reduces the height range into range as it goes,
+// transform feedback leaves it unknown
+template <typename Generator>
+void generateSurfaceOnGpu(const SurfaceKey &key, SurfaceMesh &mesh, GridTopologyRegistry &topologies, HeightRange &range, Generator &generator, Shader &program)
 {
+    range.Reset();
+    bool torus = key.choice == 3;
+    program.Activate();
+    setSurfaceParameters(program, (float)key.time);
+    if (torus)
+    {
+        GLuint buffer = mesh.ReservePositions(key, (std::size_t)TORUS_ROWS * TORUS_COLS, topologies.Get(TORUS_ROWS, TORUS_COLS, (GridLayout)key.layout));
+        generator.GenerateTorus(TORUS_ROWS, TORUS_COLS, buffer, mesh.NBO);
+        return;
+    }
+    const ChunkedGrid &grid = currentGrid();
+    GLuint buffer = mesh.ReserveHeights(key, grid, topologies);
+    generator.GenerateGrid(grid, buffer, mesh.NBO);
+}
+
+int main(int argc, char **argv)
+{
+    // use every core for mesh generation unless told otherwise
+    meshThreadCount = hardwareThreads();
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            meshThreadCount = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--gpu") == 0)
+            gpuSurfaces = true;
+        else if (std::strcmp(argv[i], "--clipmap") == 0)
+            clipmapMode = true;
+        else if (std::strcmp(argv[i], "--clipmap-step") == 0 && i + 1 < argc)
+            clipmapStep = (float)std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--clipmap-levels") == 0 && i + 1 < argc)
+            clipmapLevels = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--feedback") == 0)
+            surfaceGenerator = GENERATE_FEEDBACK;
+        else if (std::strcmp(argv[i], "--compute") == 0)
+            surfaceGenerator = GENERATE_COMPUTE;
+        else if (std::strcmp(argv[i], "--strips") == 0)
+            gridLayout = TRIANGLE_STRIP;
+        else if (std::strcmp(argv[i], "--optimized") == 0)
+            gridLayout = OPTIMIZED_LIST;
+        else if (std::strcmp(argv[i], "--heights") == 0 && i + 1 < argc)
+        {
+            i++;
+            if (std::strcmp(argv[i], "half") == 0)
+                heightFormat = HEIGHT_HALF;
+            else if (std::strcmp(argv[i], "unorm16") == 0)
+                heightFormat = HEIGHT_UNORM16;
+            else
+                heightFormat = HEIGHT_FLOAT;
+        }
+        else if (std::strcmp(argv[i], "--colormap") == 0 && i + 1 < argc)
+        {
+            i++;
+            if (std::strcmp(argv[i], "turbo") == 0)
+                colormapKind = COLORMAP_TURBO;
+            else if (std::strcmp(argv[i], "diverging") == 0)
+                colormapKind = COLORMAP_DIVERGING;
+            else
+                colormapKind = COLORMAP_VIRIDIS;
+        }
+        else if (std::strcmp(argv[i], "--shader-cache") == 0 && i + 1 < argc)
+        {
+            i++;
+            setProgramCacheDirectory(std::strcmp(argv[i], "none") == 0 ? "" : argv[i]);
+        }
+        else if (std::strcmp(argv[i], "--extent") == 0 && i + 1 < argc)
+            GRID_SIZE = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+            GRID_SAMPLES = std::atoi(argv[++i]);
+    }
+    if (GRID_SIZE < 1)
+        GRID_SIZE = 1;
+    if (GRID_SAMPLES < 2)
+        GRID_SAMPLES = 2;
+    if (meshThreadCount < 1)
+        meshThreadCount = 1;
+    if (!(clipmapStep > 0.0f))
+        clipmapStep = 0.25f;
+    if (clipmapLevels < 1)
+        clipmapLevels = 1;
+    if (clipmapLevels > MAX_CLIPMAP_LEVELS)
+        clipmapLevels = MAX_CLIPMAP_LEVELS;
+    meshThreads.Resize(meshThreadCount);
+
     // glfw: initialize and configure
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -130,6 +498,8 @@ int main()
     }
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    // the framebuffer can be larger than the window on high density displays
+    glfwGetFramebufferSize(window, &viewportWidth, &viewportHeight);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
 
@@ -144,25 +514,54 @@ int main()
         return -1;
     }
 
+    // optional features beyond GL 3.3 such as persistently mapped buffers
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
     // configure global opengl state
     glEnable(GL_DEPTH_TEST);
+    // strip layouts separate rows with the restart index, lists never contain it
+    glEnable(GL_PRIMITIVE_RESTART);
+    // the anti-aliased edges of the wireframe fade out through their alpha
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // camera matrices read by every program through the CameraBlock uniform block
+    CameraBlock cameraBlock(NEAR_PLANE, FAR_PLANE);
 
     // build and compile our shader program
     Shader ourShader("default.vert", "default.frag");
-
-    // set up vertex data (and buffer(s)) and configure vertex attributes
-    float vertices[] = {
-        0.0f, 0.0f, 0.0f};
-
-    // for plotted points
-    unsigned int VBOcurve, VAOcurve;
-    glGenVertexArrays(1, &VAOcurve);
-    glGenBuffers(1, &VBOcurve);
-    glBindVertexArray(VAOcurve);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOcurve);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
+    // same shading, but the grid functions are evaluated in the vertex shader
+    Shader surfaceShader("surface.vert", "default.frag");
+    // same shading for the levels of the geometry clipmap
+    Shader clipmapShader("clipmap.vert", "default.frag");
+
+    // height range of the plotted surface read by default.frag through the HeightRange uniform block
+    HeightRange heightRange;
+    // lookup textures the heights are coloured with
+    Colormap colormap;
+    colormap.Bind(colormapKind);
+
+    // generate plotted points into the mesh's buffer, with transform feedback on any context or compute shaders on GL 4.3+
+    FeedbackSurface feedbackSurface;
+    ComputeSurface computeSurface(heightRange.UBO);
+    if (surfaceGenerator == GENERATE_COMPUTE && !computeSurface.IsAvailable())
+        surfaceGenerator = GENERATE_FEEDBACK;
+
+    // triangle indices shared by every plotted grid of the same size
+    GridTopologyRegistry gridTopologies;
+    // for plotted points, regenerated only when its SurfaceKey changes
+    SurfaceMesh surfaceMesh;
+    // for plotted points evaluated on the GPU
+    GpuSurface gpuSurface;
+    // for plotted points around the camera over domains of any size
+    GeometryClipmap clipmap;
+    // GPU time, index count and vertex cache behaviour of the surface draws, to compare index layouts
+    GpuTimer surfaceTimer;
+    std::size_t surfaceIndices = 0;
+    std::size_t surfaceChunks = 0;
+    std::size_t surfaceChunksDrawn = 0;
+    VertexCacheStats cacheBefore = {};
+    VertexCacheStats cacheAfter = {};
 
     Shader axesShader("axes.vert", "axes.frag");
 
@@ -197,7 +596,6 @@ int main()
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
 
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     // render loop
     while (!glfwWindowShouldClose(window))
     {
@@ -216,637 +614,107 @@ int main()
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        // activate shader
-        ourShader.Activate();
-
-        // create transformations
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-
-        // retrieve the matrix uniform locations
-        unsigned int viewLoc = glGetUniformLocation(ourShader.ID, "view");
-        unsigned int projectionLoc = glGetUniformLocation(ourShader.ID, "projection");
-
-        // pass them to the shaders (3 different ways)
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-        // Render plotted mesh (choice 1: Sombrero)
-        if (choice == 1)
+        // the torus is parametric and always comes from the CPU mesh
+        bool drawClipmap = clipmapMode && choice != 3;
+        if (drawClipmap)
         {
-            std::vector<float> sombreroVertices;
-            std::vector<unsigned int> sombreroIndices;
-            int gridSize = 40;
-            float xStep = 1.0f;
-            float zStep = 1.0f;
-
-            // Generate vertex data for the sombrero function
-            for (float x = -GRID_SIZE; x < GRID_SIZE; x += xStep)
-            {
-                for (float z = -GRID_SIZE; z < GRID_SIZE; z += zStep)
-                {
-                    float y = calculateHeight(x, z);
-                    sombreroVertices.push_back(x);
-                    sombreroVertices.push_back(y);
-                    sombreroVertices.push_back(z);
-                }
-            }
-
-            // Generate indices for triangles
-            for (int row = 0; row < gridSize - 1; row++)
-            {
-                for (int col = 0; col < gridSize - 1; col++)
-                {
-                    int topLeft = row * gridSize + col;
-                    int topRight = topLeft + 1;
-                    int bottomLeft = (row + 1) * gridSize + col;
-                    int bottomRight = bottomLeft + 1;
-
-                    sombreroIndices.push_back(topLeft);
-                    sombreroIndices.push_back(bottomLeft);
-                    sombreroIndices.push_back(topRight);
-
-                    sombreroIndices.push_back(topRight);
-                    sombreroIndices.push_back(bottomLeft);
-                    sombreroIndices.push_back(bottomRight);
-                }
-            }
-
-            glBindVertexArray(VAOcurve);
-
-            // Bind the vertex buffer
-            glBindBuffer(GL_ARRAY_BUFFER, VBOcurve);
-            glBufferData(GL_ARRAY_BUFFER, sombreroVertices.size() * sizeof(float), sombreroVertices.data(), GL_STATIC_DRAW);
-
-            // Bind the element buffer
-            GLuint EBOcurve;
-            glGenBuffers(1, &EBOcurve);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOcurve);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sombreroIndices.size() * sizeof(unsigned int), sombreroIndices.data(), GL_STATIC_DRAW);
-
-            // Set the vertex attribute pointers
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-            glEnableVertexAttribArray(0);
-
-            // Calculate and set the model matrix
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-            unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-            // Set the color based on the y value
-            unsigned int colorLoc = glGetUniformLocation(ourShader.ID, "color");
-            glUniform1f(colorLoc, 1.0f); // Set a constant color for the mesh
-
-            // Draw the mesh using indices
-            glDrawElements(GL_TRIANGLES, sombreroIndices.size(), GL_UNSIGNED_INT, 0);
-
-            // Unbind the vertex array and buffers
-            glBindVertexArray(0);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-            glDeleteBuffers(1, &EBOcurve);
+            // Only the rows and columns the camera uncovered are evaluated, unless the function changed
+            updateClipmap(clipmap, currentSurfaceKey(), camera.Position);
+            float farPlane = clipmap.Extent() * 1.5f; // a little past the corner at sqrt(2) * extent
+            cameraBlock.SetPlanes(std::max(NEAR_PLANE, farPlane / CLIPMAP_DEPTH_RATIO), std::max(FAR_PLANE, farPlane));
         }
+        else
+            cameraBlock.SetPlanes(NEAR_PLANE, FAR_PLANE);
 
-        // Render plotted mesh (choice 2: ripple)
-        else if (choice == 2)
-        {
-            std::vector<float> rippleVertices;
-            std::vector<unsigned int> rippleIndices;
-            int gridSize = 40;
-            float xStep = 1.0f;
-            float zStep = 1.0f;
-
-            // Generate vertex data for the ripple function
-            for (float x = -GRID_SIZE; x < GRID_SIZE; x += xStep)
-            {
-                for (float z = -GRID_SIZE; z < GRID_SIZE; z += zStep)
-                {
-                    float y = calculateRipple(x, z);
-                    rippleVertices.push_back(x);
-                    rippleVertices.push_back(y);
-                    rippleVertices.push_back(z);
-                }
-            }
-
-            // Generate indices for triangles
-            for (int row = 0; row < gridSize - 1; row++)
-            {
-                for (int col = 0; col < gridSize - 1; col++)
-                {
-                    int topLeft = row * gridSize + col;
-                    int topRight = topLeft + 1;
-                    int bottomLeft = (row + 1) * gridSize + col;
-                    int bottomRight = bottomLeft + 1;
-
-                    rippleIndices.push_back(topLeft);
-                    rippleIndices.push_back(bottomLeft);
-                    rippleIndices.push_back(topRight);
-
-                    rippleIndices.push_back(topRight);
-                    rippleIndices.push_back(bottomLeft);
-                    rippleIndices.push_back(bottomRight);
-                }
-            }
-
-            glBindVertexArray(VAOcurve);
-
-            // Bind the vertex buffer
-            glBindBuffer(GL_ARRAY_BUFFER, VBOcurve);
-            glBufferData(GL_ARRAY_BUFFER, rippleVertices.size() * sizeof(float), rippleVertices.data(), GL_STATIC_DRAW);
-
-            // Bind the element buffer
-            GLuint EBOcurve;
-            glGenBuffers(1, &EBOcurve);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOcurve);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, rippleIndices.size() * sizeof(unsigned int), rippleIndices.data(), GL_STATIC_DRAW);
-
-            // Set the vertex attribute pointers
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-            glEnableVertexAttribArray(0);
-
-            // Calculate and set the model matrix
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-            unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-            // Set the color based on the y value
-            unsigned int colorLoc = glGetUniformLocation(ourShader.ID, "color");
-            glUniform1f(colorLoc, 1.0f); // Set a constant color for the mesh
-
-            // Draw the mesh using indices
-            glDrawElements(GL_TRIANGLES, rippleIndices.size(), GL_UNSIGNED_INT, 0);
-
-            // Unbind the vertex array and buffers
-            glBindVertexArray(0);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-            glDeleteBuffers(1, &EBOcurve);
-        }
-
-        // Render plotted mesh (choice 3: torus)
-        else if (choice == 3)
-        {
-            std::vector<float> torusVertices;
-            std::vector<unsigned int> torusIndices;
-            int numSegments = 40;
-            int numRings = 20;
-
-            for (int i = 0; i < numRings; ++i)
-            {
-                float phi = 2.5f * glm::pi<float>() * static_cast<float>(i) / numRings;
-                for (int j = 0; j < numSegments; ++j)
-                {
-                    float theta = 2.0f * glm::pi<float>() * static_cast<float>(j) / numSegments;
-
-                    float x = (radius_to_center + tube_radius * std::cos(theta)) * std::cos(phi);
-                    float y = tube_radius * std::sin(theta);
-                    float z = (radius_to_center + tube_radius * std::cos(theta)) * std::sin(phi);
-
-                    torusVertices.push_back(x);
-                    torusVertices.push_back(y);
-                    torusVertices.push_back(z);
-                }
-            }
-
-            // Generate indices for triangles
-            for (int i = 0; i < numRings - 1; ++i)
-            {
-                for (int j = 0; j < numSegments - 1; ++j)
-                {
-                    int topLeft = i * numSegments + j;
-                    int topRight = topLeft + 1;
-                    int bottomLeft = (i + 1) * numSegments + j;
-                    int bottomRight = bottomLeft + 1;
-
-                    torusIndices.push_back(topLeft);
-                    torusIndices.push_back(bottomLeft);
-                    torusIndices.push_back(topRight);
-
-                    torusIndices.push_back(topRight);
-                    torusIndices.push_back(bottomLeft);
-                    torusIndices.push_back(bottomRight);
-                }
-            }
-            glBindVertexArray(VAOcurve);
-
-            // Bind the vertex buffer
-            glBindBuffer(GL_ARRAY_BUFFER, VBOcurve);
-            glBufferData(GL_ARRAY_BUFFER, torusVertices.size() * sizeof(float), torusVertices.data(), GL_STATIC_DRAW);
-
-            // Bind the element buffer
-            GLuint EBOcurve;
-            glGenBuffers(1, &EBOcurve);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOcurve);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, torusIndices.size() * sizeof(unsigned int), torusIndices.data(), GL_STATIC_DRAW);
-
-            // Set the vertex attribute pointers
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-            glEnableVertexAttribArray(0);
-
-            // Calculate and set the model matrix
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-            unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+        // upload view and projection once for every program, only when the camera, the planes or the window changed
+        cameraBlock.Update(camera, viewportWidth, viewportHeight);
 
-            // Set the color based on the y value
-            unsigned int colorLoc = glGetUniformLocation(ourShader.ID, "color");
-            glUniform1f(colorLoc, 1.0f); // Set a constant color for the mesh
+        // activate shader
+        ourShader.Activate();
 
-            // Draw the mesh using indices
-            glDrawElements(GL_TRIANGLES, torusIndices.size(), GL_UNSIGNED_INT, 0);
+        // Calculate the model matrix
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
 
-            // Unbind the vertex array and buffers
-            glBindVertexArray(0);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-            glDeleteBuffers(1, &EBOcurve);
-        }
+        // chunks outside the view are not submitted, tested in model space with the matrices the shaders use
+        Frustum frustum(cameraBlock.data.viewProjection * model);
+        const Frustum *cullFrustum = frustumCulling ? &frustum : nullptr;
 
-        // Render plotted mesh (choice 4: Intersecting Fences)
-        else if (choice == 4)
+        if (drawClipmap)
         {
-            std::vector<float> fenceVertices;
-            std::vector<unsigned int> fenceIndices;
-            int gridSize = 40;
-            float xStep = 1.0f;
-            float zStep = 1.0f;
-
-            for (float x = -GRID_SIZE; x < GRID_SIZE; x += xStep)
-            {
-                for (float z = -GRID_SIZE; z < GRID_SIZE; z += zStep)
-                {
-                    float y = intersectingFences(x, z);
-                    fenceVertices.push_back(x);
-                    fenceVertices.push_back(y);
-                    fenceVertices.push_back(z);
-                }
-            }
-
-            // Generate indices for triangles
-            for (int row = 0; row < gridSize - 1; row++)
-            {
-                for (int col = 0; col < gridSize - 1; col++)
-                {
-                    int topLeft = row * gridSize + col;
-                    int topRight = topLeft + 1;
-                    int bottomLeft = (row + 1) * gridSize + col;
-                    int bottomRight = bottomLeft + 1;
-
-                    fenceIndices.push_back(topLeft);
-                    fenceIndices.push_back(bottomLeft);
-                    fenceIndices.push_back(topRight);
-
-                    fenceIndices.push_back(topRight);
-                    fenceIndices.push_back(bottomLeft);
-                    fenceIndices.push_back(bottomRight);
-                }
-            }
-
-            glBindVertexArray(VAOcurve);
-
-            // Bind the vertex buffer
-            glBindBuffer(GL_ARRAY_BUFFER, VBOcurve);
-            glBufferData(GL_ARRAY_BUFFER, fenceVertices.size() * sizeof(float), fenceVertices.data(), GL_STATIC_DRAW);
-
-            // Bind the element buffer
-            GLuint EBOcurve;
-            glGenBuffers(1, &EBOcurve);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOcurve);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, fenceIndices.size() * sizeof(unsigned int), fenceIndices.data(), GL_STATIC_DRAW);
-
-            // Set the vertex attribute pointers
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-            glEnableVertexAttribArray(0);
-
-            // Calculate and set the model matrix
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-            unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-            // Set the color based on the y value
-            unsigned int colorLoc = glGetUniformLocation(ourShader.ID, "color");
-            glUniform1f(colorLoc, 1.0f); // Set a constant color for the mesh
-
-            // Draw the mesh using indices
-            glDrawElements(GL_TRIANGLES, fenceIndices.size(), GL_UNSIGNED_INT, 0);
-
-            // Unbind the vertex array and buffers
-            glBindVertexArray(0);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-            glDeleteBuffers(1, &EBOcurve);
+            clipmapShader.Activate();
+            clipmapShader.SetMat4("model", model);
+            clipmapShader.SetInt("wireframe", wireframeMode);
+            // levels scroll in and out, so no range covers every height shown
+            clipmapShader.SetInt("useHeightRange", 0);
+            clipmapShader.SetInt("colormap", COLORMAP_TEXTURE_UNIT);
+
+            surfaceTimer.Begin();
+            clipmap.Draw(clipmapShader);
+            surfaceTimer.End();
+            surfaceIndices = clipmap.IndexCount();
+            // every level contains the camera, there is nothing to cull
+            surfaceChunks = clipmapLevels;
+            surfaceChunksDrawn = clipmapLevels;
+            cacheBefore = VertexCacheStats();
+            cacheAfter = VertexCacheStats();
         }
-
-        // Render plotted mesh (choice 5: Stairs)
-        else if (choice == 5)
+        else if (gpuSurfaces && choice != 3)
         {
-            std::vector<float> stairsVertices;
-            std::vector<unsigned int> stairsIndices;
-            int gridSize = 40;
-            float xStep = 1.0f;
-            float zStep = 1.0f;
-
-            for (float x = -GRID_SIZE; x < GRID_SIZE; x += xStep)
-            {
-                for (float z = -GRID_SIZE; z < GRID_SIZE; z += zStep)
-                {
-                    float y = stairs(x, z);
-                    stairsVertices.push_back(x);
-                    stairsVertices.push_back(y);
-                    stairsVertices.push_back(z);
-                }
-            }
-
-            // Generate indices for triangles
-            for (int row = 0; row < gridSize - 1; row++)
-            {
-                for (int col = 0; col < gridSize - 1; col++)
-                {
-                    int topLeft = row * gridSize + col;
-                    int topRight = topLeft + 1;
-                    int bottomLeft = (row + 1) * gridSize + col;
-                    int bottomRight = bottomLeft + 1;
-
-                    stairsIndices.push_back(topLeft);
-                    stairsIndices.push_back(bottomLeft);
-                    stairsIndices.push_back(topRight);
-
-                    stairsIndices.push_back(topRight);
-                    stairsIndices.push_back(bottomLeft);
-                    stairsIndices.push_back(bottomRight);
-                }
-            }
-
-            glBindVertexArray(VAOcurve);
-
-            // Bind the vertex buffer
-            glBindBuffer(GL_ARRAY_BUFFER, VBOcurve);
-            glBufferData(GL_ARRAY_BUFFER, stairsVertices.size() * sizeof(float), stairsVertices.data(), GL_STATIC_DRAW);
-
-            // Bind the element buffer
-            GLuint EBOcurve;
-            glGenBuffers(1, &EBOcurve);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOcurve);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, stairsIndices.size() * sizeof(unsigned int), stairsIndices.data(), GL_STATIC_DRAW);
-
-            // Set the vertex attribute pointers
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-            glEnableVertexAttribArray(0);
-
-            // Calculate and set the model matrix
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-            unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-            // Set the color based on the y value
-            unsigned int colorLoc = glGetUniformLocation(ourShader.ID, "color");
-            glUniform1f(colorLoc, 1.0f); // Set a constant color for the mesh
-
-            // Draw the mesh using indices
-            glDrawElements(GL_TRIANGLES, stairsIndices.size(), GL_UNSIGNED_INT, 0);
-
-            // Unbind the vertex array and buffers
-            glBindVertexArray(0);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-            glDeleteBuffers(1, &EBOcurve);
+            // Parameter changes and animation only cost uniform writes, nothing is rebuilt
+            surfaceShader.Activate();
+            surfaceShader.SetMat4("model", model);
+            surfaceShader.SetInt("wireframe", wireframeMode);
+            // nothing is generated, so there is no range for these heights
+            surfaceShader.SetInt("useHeightRange", 0);
+            surfaceShader.SetInt("colormap", COLORMAP_TEXTURE_UNIT);
+            setSurfaceParameters(surfaceShader, (float)glfwGetTime());
+
+            surfaceTimer.Begin();
+            gpuSurface.Draw(surfaceShader, currentGrid(), gridLayout, gridTopologies, cullFrustum);
+            surfaceTimer.End();
+            surfaceIndices = gpuSurface.IndexCount();
+            surfaceChunks = currentGrid().chunks.size();
+            surfaceChunksDrawn = gpuSurface.DrawnChunks();
+            gpuSurface.CacheStats(cacheBefore, cacheAfter);
         }
-
-        // Render plotted mesh (choice 6: Letter O)
-        else if (choice == 6)
-        {
-            std::vector<float> letterVertices;
-            std::vector<unsigned int> letterIndices;
-            int gridSize = 40;
-            float xStep = 1.0f;
-            float zStep = 1.0f;
-
-            for (float x = -GRID_SIZE; x < GRID_SIZE; x += xStep)
-            {
-                for (float z = -GRID_SIZE; z < GRID_SIZE; z += zStep)
-                {
-                    float y = letterO(x, z);
-                    letterVertices.push_back(x);
-                    letterVertices.push_back(y);
-                    letterVertices.push_back(z);
-                }
-            }
-
-            // Generate indices for triangles
-            for (int row = 0; row < gridSize - 1; row++)
-            {
-                for (int col = 0; col < gridSize - 1; col++)
-                {
-                    int topLeft = row * gridSize + col;
-                    int topRight = topLeft + 1;
-                    int bottomLeft = (row + 1) * gridSize + col;
-                    int bottomRight = bottomLeft + 1;
-
-                    letterIndices.push_back(topLeft);
-                    letterIndices.push_back(bottomLeft);
-                    letterIndices.push_back(topRight);
-
-                    letterIndices.push_back(topRight);
-                    letterIndices.push_back(bottomLeft);
-                    letterIndices.push_back(bottomRight);
-                }
-            }
-
-            glBindVertexArray(VAOcurve);
-
-            // Bind the vertex buffer
-            glBindBuffer(GL_ARRAY_BUFFER, VBOcurve);
-            glBufferData(GL_ARRAY_BUFFER, letterVertices.size() * sizeof(float), letterVertices.data(), GL_STATIC_DRAW);
-
-            // Bind the element buffer
-            GLuint EBOcurve;
-            glGenBuffers(1, &EBOcurve);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOcurve);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, letterIndices.size() * sizeof(unsigned int), letterIndices.data(), GL_STATIC_DRAW);
-
-            // Set the vertex attribute pointers
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-            glEnableVertexAttribArray(0);
-
-            // Calculate and set the model matrix
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-            unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-            // Set the color based on the y value
-            unsigned int colorLoc = glGetUniformLocation(ourShader.ID, "color");
-            glUniform1f(colorLoc, 1.0f); // Set a constant color for the mesh
-
-            // Draw the mesh using indices
-            glDrawElements(GL_TRIANGLES, letterIndices.size(), GL_UNSIGNED_INT, 0);
-
-            // Unbind the vertex array and buffers
-            glBindVertexArray(0);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-            glDeleteBuffers(1, &EBOcurve);
-        }
-
-        // Render plotted mesh (choice 7: Top Hat)
-        else if (choice == 7)
-        {
-            std::vector<float> hatVertices;
-            std::vector<unsigned int> hatIndices;
-            int gridSize = 40;
-            float xStep = 1.0f;
-            float zStep = 1.0f;
-
-            for (float x = -GRID_SIZE; x < GRID_SIZE; x += xStep)
-            {
-                for (float z = -GRID_SIZE; z < GRID_SIZE; z += zStep)
-                {
-                    float y = topHat(x, z);
-                    hatVertices.push_back(x);
-                    hatVertices.push_back(y);
-                    hatVertices.push_back(z);
-                }
-            }
-
-            // Generate indices for triangles
-            for (int row = 0; row < gridSize - 1; row++)
-            {
-                for (int col = 0; col < gridSize - 1; col++)
-                {
-                    int topLeft = row * gridSize + col;
-                    int topRight = topLeft + 1;
-                    int bottomLeft = (row + 1) * gridSize + col;
-                    int bottomRight = bottomLeft + 1;
-
-                    hatIndices.push_back(topLeft);
-                    hatIndices.push_back(bottomLeft);
-                    hatIndices.push_back(topRight);
-
-                    hatIndices.push_back(topRight);
-                    hatIndices.push_back(bottomLeft);
-                    hatIndices.push_back(bottomRight);
-                }
-            }
-
-            glBindVertexArray(VAOcurve);
-
-            // Bind the vertex buffer
-            glBindBuffer(GL_ARRAY_BUFFER, VBOcurve);
-            glBufferData(GL_ARRAY_BUFFER, hatVertices.size() * sizeof(float), hatVertices.data(), GL_STATIC_DRAW);
-
-            // Bind the element buffer
-            GLuint EBOcurve;
-            glGenBuffers(1, &EBOcurve);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOcurve);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, hatIndices.size() * sizeof(unsigned int), hatIndices.data(), GL_STATIC_DRAW);
-
-            // Set the vertex attribute pointers
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-            glEnableVertexAttribArray(0);
-
-            // Calculate and set the model matrix
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-            unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-            // Set the color based on the y value
-            unsigned int colorLoc = glGetUniformLocation(ourShader.ID, "color");
-            glUniform1f(colorLoc, 1.0f); // Set a constant color for the mesh
-
-            // Draw the mesh using indices
-            glDrawElements(GL_TRIANGLES, hatIndices.size(), GL_UNSIGNED_INT, 0);
-
-            // Unbind the vertex array and buffers
-            glBindVertexArray(0);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-            glDeleteBuffers(1, &EBOcurve);
-        }
-
-        // Render plotted mesh (choice 8: Bumps)
-        else if (choice == 8)
+        else
         {
-            std::vector<float> bumpsVertices;
-            std::vector<unsigned int> bumpsIndices;
-            int gridSize = 40;
-            float xStep = 1.0f;
-            float zStep = 1.0f;
-
-            for (float x = -GRID_SIZE; x < GRID_SIZE; x += xStep)
+            // Regenerate the plotted mesh only when the function or one of its parameters changed
+            SurfaceKey surfaceKey = currentSurfaceKey();
+            if (surfaceMesh.IsStale(surfaceKey))
             {
-                for (float z = -GRID_SIZE; z < GRID_SIZE; z += zStep)
+                if (surfaceKey.generator == GENERATE_CPU)
+                    generateSurface(surfaceKey, surfaceMesh, gridTopologies, heightRange);
+                else
                 {
-                    float y = bumps(x, z);
-                    bumpsVertices.push_back(x);
-                    bumpsVertices.push_back(y);
-                    bumpsVertices.push_back(z);
+                    // transform feedback captures heights and torus positions with separate programs
+                    if (surfaceKey.generator == GENERATE_COMPUTE)
+                        generateSurfaceOnGpu(surfaceKey, surfaceMesh, gridTopologies, heightRange, computeSurface, computeSurface.Program());
+                    else
+                        generateSurfaceOnGpu(surfaceKey, surfaceMesh, gridTopologies, heightRange, feedbackSurface, feedbackSurface.Program(surfaceKey.choice == 3));
+                    ourShader.Activate();
                 }
             }
 
-            // Generate indices for triangles
-            for (int row = 0; row < gridSize - 1; row++)
-            {
-                for (int col = 0; col < gridSize - 1; col++)
-                {
-                    int topLeft = row * gridSize + col;
-                    int topRight = topLeft + 1;
-                    int bottomLeft = (row + 1) * gridSize + col;
-                    int bottomRight = bottomLeft + 1;
-
-                    bumpsIndices.push_back(topLeft);
-                    bumpsIndices.push_back(bottomLeft);
-                    bumpsIndices.push_back(topRight);
-
-                    bumpsIndices.push_back(topRight);
-                    bumpsIndices.push_back(bottomLeft);
-                    bumpsIndices.push_back(bottomRight);
-                }
-            }
-
-            glBindVertexArray(VAOcurve);
-
-            // Bind the vertex buffer
-            glBindBuffer(GL_ARRAY_BUFFER, VBOcurve);
-            glBufferData(GL_ARRAY_BUFFER, bumpsVertices.size() * sizeof(float), bumpsVertices.data(), GL_STATIC_DRAW);
-
-            // Bind the element buffer
-            GLuint EBOcurve;
-            glGenBuffers(1, &EBOcurve);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBOcurve);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, bumpsIndices.size() * sizeof(unsigned int), bumpsIndices.data(), GL_STATIC_DRAW);
-
-            // Set the vertex attribute pointers
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-            glEnableVertexAttribArray(0);
-
-            // Calculate and set the model matrix
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-            unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-            // Set the color based on the y value
-            unsigned int colorLoc = glGetUniformLocation(ourShader.ID, "color");
-            glUniform1f(colorLoc, 1.0f); // Set a constant color for the mesh
+            // Set the model matrix
+            ourShader.SetMat4("model", model);
+            ourShader.SetInt("wireframe", wireframeMode);
+            ourShader.SetInt("useHeightRange", 1);
+            ourShader.SetInt("colormap", COLORMAP_TEXTURE_UNIT);
 
             // Draw the mesh using indices
-            glDrawElements(GL_TRIANGLES, bumpsIndices.size(), GL_UNSIGNED_INT, 0);
-
-            // Unbind the vertex array and buffers
-            glBindVertexArray(0);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-            glDeleteBuffers(1, &EBOcurve);
+            surfaceTimer.Begin();
+            surfaceMesh.Draw(ourShader, cullFrustum);
+            surfaceTimer.End();
+            surfaceIndices = surfaceMesh.IndexCount();
+            surfaceChunks = surfaceMesh.chunks.size();
+            surfaceChunksDrawn = surfaceMesh.DrawnChunks();
+            surfaceMesh.CacheStats(cacheBefore, cacheAfter);
         }
 
         // ourShader.Delete();
         axesShader.Activate();
-        // retrieve the matrix uniform locations
-        viewLoc = glGetUniformLocation(axesShader.ID, "view");
-        projectionLoc = glGetUniformLocation(axesShader.ID, "projection");
-
-        // pass them to the shaders
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
         glBindVertexArray(VAOaxes);
         glDrawArrays(GL_LINES, 0, 6);
 
@@ -912,10 +780,55 @@ int main()
         ImGui::RadioButton("Letter O", &choice, 6);
         ImGui::RadioButton("Top Hat", &choice, 7);
         ImGui::RadioButton("Bumps", &choice, 8);
-        if (ImGui::Checkbox("Wireframe Mode", &wireframeMode))
+        // restarting the pool is expensive, so it is resized once the slider is released rather than while dragging
+        ImGui::SliderInt("Mesh Threads", &meshThreadCount, 1, hardwareThreads());
+        if (ImGui::IsItemDeactivatedAfterEdit())
+        {
+            meshThreads.Resize(meshThreadCount);
+        }
+        ImGui::SliderInt("Grid Extent", &GRID_SIZE, 1, MAX_GRID_SIZE, "%d", ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp);
+        ImGui::SliderInt("Grid Samples", &GRID_SAMPLES, 2, MAX_GRID_SAMPLES, "%d", ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp);
+        ImGui::Checkbox("GPU Evaluation", &gpuSurfaces);
+        ImGui::Checkbox("Geometry Clipmap", &clipmapMode);
+        if (clipmapMode)
+        {
+            ImGui::SliderFloat("Clipmap Spacing", &clipmapStep, 0.01f, 10.0f, "%.3f", ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_AlwaysClamp);
+            ImGui::SliderInt("Clipmap Levels", &clipmapLevels, 1, MAX_CLIPMAP_LEVELS, "%d", ImGuiSliderFlags_AlwaysClamp);
+            ImGui::Text("Clipmap: %zu vertices covering +-%.0f", clipmap.VertexCount(), clipmap.Extent());
+        }
+        // in SurfaceGenerator order, compute shaders are only offered when the context has them
+        const char *generators[] = {"CPU", "Transform Feedback", "Compute Shader"};
+        int generator = surfaceGenerator;
+        if (ImGui::Combo("Mesh Generation", &generator, generators, computeSurface.IsAvailable() ? SURFACE_GENERATOR_COUNT : GENERATE_COMPUTE))
+            surfaceGenerator = (SurfaceGenerator)generator;
+        // in GridLayout order
+        const char *layouts[] = {"Triangle List", "Triangle Strips", "Vertex Cache Optimized List"};
+        int layout = gridLayout;
+        if (ImGui::Combo("Index Layout", &layout, layouts, GRID_LAYOUT_COUNT))
+            gridLayout = (GridLayout)layout;
+        // in HeightFormat order
+        const char *formats[] = {"32-bit Float", "16-bit Half Float", "16-bit Normalized"};
+        int format = heightFormat;
+        if (ImGui::Combo("Height Format", &format, formats, HEIGHT_FORMAT_COUNT))
+            heightFormat = (HeightFormat)format;
+        ImGui::Checkbox("Frustum Culling", &frustumCulling);
+        ImGui::Text("Surface: %zu indices, %.3f ms GPU", surfaceIndices, surfaceTimer.Milliseconds());
+        ImGui::Text("Chunks drawn: %zu of %zu", surfaceChunksDrawn, surfaceChunks);
+        if (cacheAfter.triangles > 0)
+            ImGui::Text("Vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", cacheBefore.ACMR(), cacheAfter.ACMR(), cacheBefore.ATVR(), cacheAfter.ATVR());
+        // in ColormapKind order
+        const char *colormaps[] = {"Viridis", "Turbo", "Diverging"};
+        int colormapIndex = colormapKind;
+        if (ImGui::Combo("Colormap", &colormapIndex, colormaps, COLORMAP_COUNT))
         {
-            glPolygonMode(GL_FRONT_AND_BACK, wireframeMode ? GL_LINE : GL_FILL);
+            colormapKind = (ColormapKind)colormapIndex;
+            colormap.Bind(colormapKind);
         }
+        // in WireframeMode order, drawn by default.frag so no GL state changes
+        const char *wireframes[] = {"Off", "Lines", "Lines over Surface"};
+        int wireframe = wireframeMode;
+        if (ImGui::Combo("Wireframe Mode", &wireframe, wireframes, WIREFRAME_MODE_COUNT))
+            wireframeMode = (WireframeMode)wireframe;
         ImGui::End();
 
         ImGui::Render();
@@ -929,8 +842,16 @@ int main()
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
-    glDeleteVertexArrays(1, &VAOcurve);
-    glDeleteBuffers(1, &VBOcurve);
+    surfaceMesh.Delete();
+    gpuSurface.Delete();
+    clipmap.Delete();
+    surfaceTimer.Delete();
+    gridTopologies.Delete();
+    computeSurface.Delete();
+    heightRange.Delete();
+    colormap.Delete();
+    feedbackSurface.Delete();
+    cameraBlock.Delete();
     glDeleteVertexArrays(1, &VAOaxes);
     glDeleteBuffers(1, &VBOaxes);
 
@@ -1035,6 +956,8 @@ void framebuffer_size_callback(GLFWwindow *window, int width, int height)
     // make sure the viewport matches the new window dimensions; note that width and
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
+    viewportWidth = width;
+    viewportHeight = height;
 }
 void mouse_callback(GLFWwindow *window, double xposIn, double yposIn)
 {
@@ -0,0 +1,164 @@
+#include"programCache.h"
+#include"glExtensions.h"
+
+#include<cstdint>
+#include<cstdio>
+#include<fstream>
+#include<vector>
+#ifdef _WIN32
+#include<direct.h>
+#else
+#include<sys/stat.h>
+#endif
+
+// Identifies a cache file and its layout: magic, format, length, then the binary
+static const std::uint32_t PROGRAM_CACHE_MAGIC = 0x31425046; // "FPB1"
+
+static std::string cacheDirectory = PROGRAM_CACHE_DIRECTORY;
+
+// Sets the directory linked programs are saved to and loaded from, an empty path disables the cache
+void setProgramCacheDirectory(const std::string& directory)
+{
+	cacheDirectory = directory;
+}
+
+// 64-bit FNV-1a, continuing from hash
+static std::uint64_t hashBytes(std::uint64_t hash, const char* data, std::size_t size)
+{
+	for (std::size_t i = 0; i < size; i++)
+	{
+		hash ^= (unsigned char)data[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+// Hashes a string followed by its length, so the boundary between two strings is part of the hash
+static std::uint64_t hashString(std::uint64_t hash, const std::string& text)
+{
+	std::uint64_t size = text.size();
+	hash = hashBytes(hash, text.data(), text.size());
+	return hashBytes(hash, (const char*)&size, sizeof(size));
+}
+
+// Hashes a string of the current context
+static std::uint64_t hashGLString(std::uint64_t hash, GLenum name)
+{
+	const char* value = (const char*)glGetString(name);
+	return hashString(hash, value != nullptr ? value : "");
+}
+
+// Finishes a key with the strings of the current context
+static std::string contextKey(std::uint64_t hash)
+{
+	hash = hashGLString(hash, GL_VENDOR);
+	hash = hashGLString(hash, GL_RENDERER);
+	hash = hashGLString(hash, GL_VERSION);
+
+	char key[17];
+	std::snprintf(key, sizeof(key), "%016llx", (unsigned long long)hash);
+	return key;
+}
+
+// Key of a program: a hash of its sources and of the vendor, renderer and version of the current context,
+// so editing a shader or changing the driver makes the saved binary unreachable
+std::string programCacheKey(const std::string& vertexCode, const std::string& fragmentCode)
+{
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+	hash = hashString(hash, vertexCode);
+	hash = hashString(hash, fragmentCode);
+	return contextKey(hash);
+}
+
+// Key of a vertex program whose outputs are captured with transform feedback
+std::string programCacheKey(const std::string& vertexCode, const std::vector<std::string>& feedbackVaryings)
+{
+	// The captured outputs are part of the linked program
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+	hash = hashString(hash, "feedback");
+	hash = hashString(hash, vertexCode);
+	for (std::size_t i = 0; i < feedbackVaryings.size(); i++)
+		hash = hashString(hash, feedbackVaryings[i]);
+	return contextKey(hash);
+}
+
+// Key of a compute program
+std::string programCacheKey(const std::string& computeCode)
+{
+	// The stage is hashed too, so the key cannot match a vertex and fragment pair
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+	hash = hashString(hash, "compute");
+	hash = hashString(hash, computeCode);
+	return contextKey(hash);
+}
+
+// Path of the file the binary of key is saved in
+static std::string cachePath(const std::string& key)
+{
+	return cacheDirectory + "/" + key + ".bin";
+}
+
+// Loads the binary saved under key into program, returns false when there is none or the driver rejects it
+bool loadProgramBinary(GLuint program, const std::string& key)
+{
+	if (!GLAD_GL_ARB_get_program_binary || cacheDirectory.empty())
+		return false;
+
+	std::ifstream in(cachePath(key), std::ios::binary);
+	if (!in)
+		return false;
+	std::uint32_t header[3] = {};
+	if (!in.read((char*)header, sizeof(header)) || header[0] != PROGRAM_CACHE_MAGIC || header[2] == 0)
+		return false;
+	std::vector<char> binary(header[2]);
+	if (!in.read(binary.data(), binary.size()))
+		return false;
+
+	// The driver may still refuse a binary, for example after an update that kept its version string
+	glProgramBinary(program, (GLenum)header[1], binary.data(), (GLsizei)binary.size());
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	return linked == GL_TRUE;
+}
+
+// Saves the binary of a linked program under key
+void storeProgramBinary(GLuint program, const std::string& key)
+{
+	if (!GLAD_GL_ARB_get_program_binary || cacheDirectory.empty())
+		return;
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	GLsizei written = 0;
+	glGetProgramBinary(program, length, &written, &format, binary.data());
+	if (written <= 0)
+		return;
+
+#ifdef _WIN32
+	_mkdir(cacheDirectory.c_str());
+#else
+	mkdir(cacheDirectory.c_str(), 0755);
+#endif
+	// Write next to the final file and move it in place, so a crash never leaves a truncated binary behind
+	std::string path = cachePath(key);
+	std::string temporary = path + ".tmp";
+	{
+		std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+		std::uint32_t header[3] = { PROGRAM_CACHE_MAGIC, (std::uint32_t)format, (std::uint32_t)written };
+		out.write((const char*)header, sizeof(header));
+		out.write(binary.data(), written);
+		if (!out)
+		{
+			out.close();
+			std::remove(temporary.c_str());
+			return;
+		}
+	}
+	std::remove(path.c_str());
+	if (std::rename(temporary.c_str(), path.c_str()) != 0)
+		std::remove(temporary.c_str());
+}
@@ -0,0 +1,24 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include<glad/glad.h>
+#include<string>
+#include<vector>
+
+// Default directory linked programs are saved to, relative to the working directory like the shader sources
+const char* const PROGRAM_CACHE_DIRECTORY = "shadercache";
+
+// Sets the directory linked programs are saved to and loaded from, an empty path disables the cache
+void setProgramCacheDirectory(const std::string& directory);
+// Key of a program: a hash of its sources and of the vendor, renderer and version of the current context,
+// so editing a shader or changing the driver makes the saved binary unreachable
+std::string programCacheKey(const std::string& vertexCode, const std::string& fragmentCode);
+// Key of a vertex program whose outputs are captured with transform feedback
+std::string programCacheKey(const std::string& vertexCode, const std::vector<std::string>& feedbackVaryings);
+// Key of a compute program
+std::string programCacheKey(const std::string& computeCode);
+// Loads the binary saved under key into program, returns false when there is none or the driver rejects it
+bool loadProgramBinary(GLuint program, const std::string& key);
+// Saves the binary of a linked program under key
+void storeProgramBinary(GLuint program, const std::string& key);
+#endif
@@ -1,4 +1,9 @@
 #include"shaderClass.h"
+#include"cameraBlock.h"
+#include"glExtensions.h"
+#include"heightRange.h"
+#include"programCache.h"
+#include<cstring>
 
 // Reads a text file and outputs a string with everything in the text file
 std::string get_file_contents(const char* filename)
@@ -24,6 +29,75 @@ Shader::Shader(const char* vertexFile, const char* fragmentFile)
 	std::string vertexCode = get_file_contents(vertexFile);
 	std::string fragmentCode = get_file_contents(fragmentFile);
 
+	// Reuse the program linked by an earlier run when the sources and the driver are the same
+	std::string cacheKey = programCacheKey(vertexCode, fragmentCode);
+	ID = glCreateProgram();
+	if (!loadProgramBinary(ID, cacheKey))
+	{
+		// Start over from a fresh program rather than one the driver refused a binary for
+		glDeleteProgram(ID);
+		ID = glCreateProgram();
+		if (Compile(vertexCode, fragmentCode))
+			storeProgramBinary(ID, cacheKey);
+	}
+
+	Prepare();
+}
+
+// Constructor that builds a vertex-only program whose feedbackVaryings outputs are captured with transform feedback
+Shader::Shader(const char* vertexFile, const std::vector<std::string>& feedbackVaryings)
+{
+	std::string vertexCode = get_file_contents(vertexFile);
+
+	std::string cacheKey = programCacheKey(vertexCode, feedbackVaryings);
+	ID = glCreateProgram();
+	if (!loadProgramBinary(ID, cacheKey))
+	{
+		glDeleteProgram(ID);
+		ID = glCreateProgram();
+		if (CompileFeedback(vertexCode, feedbackVaryings))
+			storeProgramBinary(ID, cacheKey);
+	}
+
+	Prepare();
+}
+
+// Constructor that builds a compute program, the context must support compute shaders
+Shader::Shader(const char* computeFile)
+{
+	std::string computeCode = get_file_contents(computeFile);
+
+	std::string cacheKey = programCacheKey(computeCode);
+	ID = glCreateProgram();
+	if (!loadProgramBinary(ID, cacheKey))
+	{
+		glDeleteProgram(ID);
+		ID = glCreateProgram();
+		if (CompileCompute(computeCode))
+			storeProgramBinary(ID, cacheKey);
+	}
+
+	Prepare();
+}
+
+// Looks up the active uniforms and binds the shared uniform blocks, once the program is linked
+void Shader::Prepare()
+{
+	IntrospectUniforms();
+
+	// Programs reading the camera matrices get them from the shared buffer
+	GLuint cameraBlock = glGetUniformBlockIndex(ID, CAMERA_BLOCK_NAME);
+	if (cameraBlock != GL_INVALID_INDEX)
+		glUniformBlockBinding(ID, cameraBlock, CAMERA_BLOCK_BINDING);
+	// and the height range of the plotted surface from its own
+	GLuint heightRange = glGetUniformBlockIndex(ID, HEIGHT_RANGE_NAME);
+	if (heightRange != GL_INVALID_INDEX)
+		glUniformBlockBinding(ID, heightRange, HEIGHT_RANGE_BINDING);
+}
+
+// Compiles both shaders and links them into the Shader Program, returns whether linking succeeded
+bool Shader::Compile(const std::string& vertexCode, const std::string& fragmentCode)
+{
 	// Convert the shader source strings into character arrays
 	const char* vertexSource = vertexCode.c_str();
 	const char* fragmentSource = fragmentCode.c_str();
@@ -42,18 +116,155 @@ Shader::Shader(const char* vertexFile, const char* fragmentFile)
 	// Compile the Vertex Shader into machine code
 	glCompileShader(fragmentShader);
 
-	// Create Shader Program Object and get its reference
-	ID = glCreateProgram();
 	// Attach the Vertex and Fragment Shaders to the Shader Program
 	glAttachShader(ID, vertexShader);
 	glAttachShader(ID, fragmentShader);
 	// Wrap-up/Link all the shaders together into the Shader Program
-	glLinkProgram(ID);
+	bool linked = Link();
 
 	// Delete the now useless Vertex and Fragment Shader objects
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
+	return linked;
+}
+
+// Compiles the vertex shader and links it, capturing feedbackVaryings, returns whether linking succeeded
+bool Shader::CompileFeedback(const std::string& vertexCode, const std::vector<std::string>& feedbackVaryings)
+{
+	const char* vertexSource = vertexCode.c_str();
+
+	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertexShader, 1, &vertexSource, NULL);
+	glCompileShader(vertexShader);
+	glAttachShader(ID, vertexShader);
+
+	// The captured outputs have to be known before linking, each one written into its own buffer binding
+	std::vector<const char*> names;
+	for (std::size_t i = 0; i < feedbackVaryings.size(); i++)
+		names.push_back(feedbackVaryings[i].c_str());
+	glTransformFeedbackVaryings(ID, (GLsizei)names.size(), names.data(), GL_SEPARATE_ATTRIBS);
 
+	bool linked = Link();
+	glDeleteShader(vertexShader);
+	return linked;
+}
+
+// Compiles the compute shader and links it into the program, returns whether linking succeeded
+bool Shader::CompileCompute(const std::string& computeCode)
+{
+	const char* computeSource = computeCode.c_str();
+
+	GLuint computeShader = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(computeShader, 1, &computeSource, NULL);
+	glCompileShader(computeShader);
+
+	glAttachShader(ID, computeShader);
+	bool linked = Link();
+	glDeleteShader(computeShader);
+	return linked;
+}
+
+// Links the attached shaders, keeping the binary retrievable for the program cache
+bool Shader::Link()
+{
+	// Ask the driver to keep the linked binary around so it can be cached
+	if (GLAD_GL_ARB_get_program_binary)
+		glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(ID);
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+	return linked == GL_TRUE;
+}
+
+// Reads the active uniforms of the linked program into the lookup table
+void Shader::IntrospectUniforms()
+{
+	uniformIndex.clear();
+	uniforms.clear();
+
+	GLint count = 0;
+	GLint maxLength = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	std::vector<char> name(maxLength > 0 ? maxLength : 1);
+
+	for (GLint i = 0; i < count; i++)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(ID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+		std::string uniformName(name.data(), length);
+		GLint location = glGetUniformLocation(ID, uniformName.c_str());
+		// Uniforms inside a block have no location and are set through their buffer
+		if (location < 0)
+			continue;
+		// Arrays are reported as "name[0]", look them up by their plain name
+		std::size_t bracket = uniformName.find('[');
+		if (bracket != std::string::npos)
+			uniformName.resize(bracket);
+
+		UniformSlot slot = {};
+		slot.location = location;
+		slot.type = type;
+		slot.known = false;
+		uniformIndex[uniformName] = (int)uniforms.size();
+		uniforms.push_back(slot);
+	}
+}
+
+// Location of an active uniform, -1 when the program does not use it
+GLint Shader::Location(const char* name) const
+{
+	auto it = uniformIndex.find(name);
+	return it == uniformIndex.end() ? -1 : uniforms[it->second].location;
+}
+
+// Slot of a uniform when its value differs from the cached one, nullptr when there is nothing to upload
+UniformSlot* Shader::Changed(const char* name, const void* value, std::size_t bytes)
+{
+	auto it = uniformIndex.find(name);
+	if (it == uniformIndex.end())
+		return nullptr;
+	UniformSlot& slot = uniforms[it->second];
+	if (slot.known && std::memcmp(slot.value, value, bytes) == 0)
+		return nullptr;
+	std::memcpy(slot.value, value, bytes);
+	slot.known = true;
+	return &slot;
+}
+
+void Shader::SetInt(const char* name, GLint value)
+{
+	if (UniformSlot* slot = Changed(name, &value, sizeof(value)))
+		glUniform1i(slot->location, value);
+}
+
+void Shader::SetFloat(const char* name, GLfloat value)
+{
+	if (UniformSlot* slot = Changed(name, &value, sizeof(value)))
+		glUniform1f(slot->location, value);
+}
+
+void Shader::SetVec2(const char* name, GLfloat x, GLfloat y)
+{
+	GLfloat value[2] = { x, y };
+	if (UniformSlot* slot = Changed(name, value, sizeof(value)))
+		glUniform2fv(slot->location, 1, value);
+}
+
+void Shader::SetIVec2(const char* name, GLint x, GLint y)
+{
+	GLint value[2] = { x, y };
+	if (UniformSlot* slot = Changed(name, value, sizeof(value)))
+		glUniform2iv(slot->location, 1, value);
+}
+
+void Shader::SetMat4(const char* name, const glm::mat4& value)
+{
+	if (UniformSlot* slot = Changed(name, &value[0][0], sizeof(value)))
+		glUniformMatrix4fv(slot->location, 1, GL_FALSE, &value[0][0]);
 }
 
 // Activates the Shader Program
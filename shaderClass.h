@@ -2,7 +2,10 @@
 #define SHADER_CLASS_H
 
 #include<glad/glad.h>
+#include<glm/glm.hpp>
 #include<string>
+#include<map>
+#include<vector>
 #include<fstream>
 #include<sstream>
 #include<iostream>
@@ -10,6 +13,17 @@
 
 std::string get_file_contents(const char* filename);
 
+// An active uniform of a linked program and the last value uploaded to it
+struct UniformSlot
+{
+	GLint location;
+	GLenum type;
+	// Whether value holds what the program currently has
+	bool known;
+	// Large enough for a mat4, ints are stored bitwise
+	float value[16];
+};
+
 class Shader
 {
 public:
@@ -17,10 +31,43 @@ public:
 	GLuint ID;
 	// Constructor that build the Shader Program from 2 different shaders
 	Shader(const char* vertexFile, const char* fragmentFile);
+	// Constructor that builds a vertex-only program whose feedbackVaryings outputs are captured with transform feedback
+	Shader(const char* vertexFile, const std::vector<std::string>& feedbackVaryings);
+	// Constructor that builds a compute program, the context must support compute shaders
+	explicit Shader(const char* computeFile);
 
 	// Activates the Shader Program
 	void Activate();
 	// Deletes the Shader Program
 	void Delete();
+
+	// Location of an active uniform, -1 when the program does not use it
+	GLint Location(const char* name) const;
+	// Typed setters, the program must be active. A value equal to the last one uploaded is skipped
+	void SetInt(const char* name, GLint value);
+	void SetFloat(const char* name, GLfloat value);
+	void SetVec2(const char* name, GLfloat x, GLfloat y);
+	void SetIVec2(const char* name, GLint x, GLint y);
+	void SetMat4(const char* name, const glm::mat4& value);
+
+private:
+	// Active uniforms, looked up by name without building a std::string
+	std::map<std::string, int, std::less<>> uniformIndex;
+	std::vector<UniformSlot> uniforms;
+
+	// Compiles both shaders and links them into the Shader Program, returns whether linking succeeded
+	bool Compile(const std::string& vertexCode, const std::string& fragmentCode);
+	// Compiles the vertex shader and links it, capturing feedbackVaryings, returns whether linking succeeded
+	bool CompileFeedback(const std::string& vertexCode, const std::vector<std::string>& feedbackVaryings);
+	// Compiles the compute shader and links it into the program, returns whether linking succeeded
+	bool CompileCompute(const std::string& computeCode);
+	// Links the attached shaders, keeping the binary retrievable for the program cache
+	bool Link();
+	// Looks up the active uniforms and binds the shared uniform blocks, once the program is linked
+	void Prepare();
+	// Reads the active uniforms of the linked program into the lookup table
+	void IntrospectUniforms();
+	// Slot of a uniform when its value differs from the cached one, nullptr when there is nothing to upload
+	UniformSlot* Changed(const char* name, const void* value, std::size_t bytes);
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,276 @@
+#ifndef SIMD_MATH_H
+#define SIMD_MATH_H
+
+#include<cmath>
+#include<cstring>
+#include<stdint.h>
+
+// Instruction set used by the batch surface kernels, picked at compile time the same way
+// glm/simd/platform.h does. Define SIMD_FORCE_SCALAR to build the one-lane reference path
+#if defined(SIMD_FORCE_SCALAR)
+#	define SIMD_SCALAR
+#elif defined(__AVX2__)
+#	define SIMD_AVX2
+#	include<immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define SIMD_SSE2
+#	include<emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#	define SIMD_NEON
+#	include<arm_neon.h>
+#else
+#	define SIMD_SCALAR
+#endif
+
+namespace simd
+{
+	// Lane-wise float and int32 vectors with the handful of operations the kernels need.
+	// Masks are vectors with every bit of a lane set or cleared. min and max return b when a is NaN
+	// on every backend, which the height bounds rely on to leave NaN samples out
+#if defined(SIMD_AVX2)
+	const int WIDTH = 8;
+	struct vfloat { __m256 v; };
+	struct vint { __m256i v; };
+
+	inline vfloat set1(float a) { vfloat r = { _mm256_set1_ps(a) }; return r; }
+	inline vint set1i(int32_t a) { vint r = { _mm256_set1_epi32(a) }; return r; }
+	inline vfloat ramp() { vfloat r = { _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f) }; return r; }
+	inline vfloat load(const float* p) { vfloat r = { _mm256_loadu_ps(p) }; return r; }
+	inline void store(float* p, vfloat a) { _mm256_storeu_ps(p, a.v); }
+	inline void storei(int32_t* p, vint a) { _mm256_storeu_si256((__m256i*)p, a.v); }
+	inline vfloat operator+(vfloat a, vfloat b) { vfloat r = { _mm256_add_ps(a.v, b.v) }; return r; }
+	inline vfloat operator-(vfloat a, vfloat b) { vfloat r = { _mm256_sub_ps(a.v, b.v) }; return r; }
+	inline vfloat operator*(vfloat a, vfloat b) { vfloat r = { _mm256_mul_ps(a.v, b.v) }; return r; }
+	inline vfloat operator/(vfloat a, vfloat b) { vfloat r = { _mm256_div_ps(a.v, b.v) }; return r; }
+	inline vfloat sqrt(vfloat a) { vfloat r = { _mm256_sqrt_ps(a.v) }; return r; }
+	inline vfloat min(vfloat a, vfloat b) { vfloat r = { _mm256_min_ps(a.v, b.v) }; return r; }
+	inline vfloat max(vfloat a, vfloat b) { vfloat r = { _mm256_max_ps(a.v, b.v) }; return r; }
+	inline vfloat floor(vfloat a) { vfloat r = { _mm256_floor_ps(a.v) }; return r; }
+	inline vint truncate(vfloat a) { vint r = { _mm256_cvttps_epi32(a.v) }; return r; }
+	inline vfloat toFloat(vint a) { vfloat r = { _mm256_cvtepi32_ps(a.v) }; return r; }
+	inline vfloat asFloat(vint a) { vfloat r = { _mm256_castsi256_ps(a.v) }; return r; }
+	inline vint asInt(vfloat a) { vint r = { _mm256_castps_si256(a.v) }; return r; }
+	inline vint operator+(vint a, vint b) { vint r = { _mm256_add_epi32(a.v, b.v) }; return r; }
+	inline vint operator-(vint a, vint b) { vint r = { _mm256_sub_epi32(a.v, b.v) }; return r; }
+	inline vint operator&(vint a, vint b) { vint r = { _mm256_and_si256(a.v, b.v) }; return r; }
+	inline vint operator^(vint a, vint b) { vint r = { _mm256_xor_si256(a.v, b.v) }; return r; }
+	// a & ~b
+	inline vint andNot(vint a, vint b) { vint r = { _mm256_andnot_si256(b.v, a.v) }; return r; }
+	template <int N> inline vint shiftLeft(vint a) { vint r = { _mm256_slli_epi32(a.v, N) }; return r; }
+	inline vint equal(vint a, vint b) { vint r = { _mm256_cmpeq_epi32(a.v, b.v) }; return r; }
+	inline vint equal(vfloat a, vfloat b) { vint r = { _mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)) }; return r; }
+	inline vfloat select(vint mask, vfloat a, vfloat b) { vfloat r = { _mm256_blendv_ps(b.v, a.v, _mm256_castsi256_ps(mask.v)) }; return r; }
+#elif defined(SIMD_SSE2)
+	const int WIDTH = 4;
+	struct vfloat { __m128 v; };
+	struct vint { __m128i v; };
+
+	inline vfloat set1(float a) { vfloat r = { _mm_set1_ps(a) }; return r; }
+	inline vint set1i(int32_t a) { vint r = { _mm_set1_epi32(a) }; return r; }
+	inline vfloat ramp() { vfloat r = { _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f) }; return r; }
+	inline vfloat load(const float* p) { vfloat r = { _mm_loadu_ps(p) }; return r; }
+	inline void store(float* p, vfloat a) { _mm_storeu_ps(p, a.v); }
+	inline void storei(int32_t* p, vint a) { _mm_storeu_si128((__m128i*)p, a.v); }
+	inline vfloat operator+(vfloat a, vfloat b) { vfloat r = { _mm_add_ps(a.v, b.v) }; return r; }
+	inline vfloat operator-(vfloat a, vfloat b) { vfloat r = { _mm_sub_ps(a.v, b.v) }; return r; }
+	inline vfloat operator*(vfloat a, vfloat b) { vfloat r = { _mm_mul_ps(a.v, b.v) }; return r; }
+	inline vfloat operator/(vfloat a, vfloat b) { vfloat r = { _mm_div_ps(a.v, b.v) }; return r; }
+	inline vfloat sqrt(vfloat a) { vfloat r = { _mm_sqrt_ps(a.v) }; return r; }
+	inline vfloat min(vfloat a, vfloat b) { vfloat r = { _mm_min_ps(a.v, b.v) }; return r; }
+	inline vfloat max(vfloat a, vfloat b) { vfloat r = { _mm_max_ps(a.v, b.v) }; return r; }
+	inline vint truncate(vfloat a) { vint r = { _mm_cvttps_epi32(a.v) }; return r; }
+	inline vfloat toFloat(vint a) { vfloat r = { _mm_cvtepi32_ps(a.v) }; return r; }
+	// SSE2 has no rounding instruction: truncate, then step down where that rounded up
+	inline vfloat floor(vfloat a)
+	{
+		__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+		__m128 up = _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f));
+		vfloat r = { _mm_sub_ps(t, up) };
+		return r;
+	}
+	inline vfloat asFloat(vint a) { vfloat r = { _mm_castsi128_ps(a.v) }; return r; }
+	inline vint asInt(vfloat a) { vint r = { _mm_castps_si128(a.v) }; return r; }
+	inline vint operator+(vint a, vint b) { vint r = { _mm_add_epi32(a.v, b.v) }; return r; }
+	inline vint operator-(vint a, vint b) { vint r = { _mm_sub_epi32(a.v, b.v) }; return r; }
+	inline vint operator&(vint a, vint b) { vint r = { _mm_and_si128(a.v, b.v) }; return r; }
+	inline vint operator^(vint a, vint b) { vint r = { _mm_xor_si128(a.v, b.v) }; return r; }
+	// a & ~b
+	inline vint andNot(vint a, vint b) { vint r = { _mm_andnot_si128(b.v, a.v) }; return r; }
+	template <int N> inline vint shiftLeft(vint a) { vint r = { _mm_slli_epi32(a.v, N) }; return r; }
+	inline vint equal(vint a, vint b) { vint r = { _mm_cmpeq_epi32(a.v, b.v) }; return r; }
+	inline vint equal(vfloat a, vfloat b) { vint r = { _mm_castps_si128(_mm_cmpeq_ps(a.v, b.v)) }; return r; }
+	inline vfloat select(vint mask, vfloat a, vfloat b)
+	{
+		__m128 m = _mm_castsi128_ps(mask.v);
+		vfloat r = { _mm_or_ps(_mm_and_ps(m, a.v), _mm_andnot_ps(m, b.v)) };
+		return r;
+	}
+#elif defined(SIMD_NEON)
+	const int WIDTH = 4;
+	struct vfloat { float32x4_t v; };
+	struct vint { int32x4_t v; };
+
+	inline vfloat set1(float a) { vfloat r = { vdupq_n_f32(a) }; return r; }
+	inline vint set1i(int32_t a) { vint r = { vdupq_n_s32(a) }; return r; }
+	inline vfloat ramp() { const float lanes[4] = { 0.0f, 1.0f, 2.0f, 3.0f }; vfloat r = { vld1q_f32(lanes) }; return r; }
+	inline vfloat load(const float* p) { vfloat r = { vld1q_f32(p) }; return r; }
+	inline void store(float* p, vfloat a) { vst1q_f32(p, a.v); }
+	inline void storei(int32_t* p, vint a) { vst1q_s32(p, a.v); }
+	inline vfloat operator+(vfloat a, vfloat b) { vfloat r = { vaddq_f32(a.v, b.v) }; return r; }
+	inline vfloat operator-(vfloat a, vfloat b) { vfloat r = { vsubq_f32(a.v, b.v) }; return r; }
+	inline vfloat operator*(vfloat a, vfloat b) { vfloat r = { vmulq_f32(a.v, b.v) }; return r; }
+	inline vfloat operator/(vfloat a, vfloat b) { vfloat r = { vdivq_f32(a.v, b.v) }; return r; }
+	inline vfloat sqrt(vfloat a) { vfloat r = { vsqrtq_f32(a.v) }; return r; }
+	// vminq/vmaxq would return NaN, the IEEE minNum/maxNum forms return the number like the x86 backends do
+	inline vfloat min(vfloat a, vfloat b) { vfloat r = { vminnmq_f32(a.v, b.v) }; return r; }
+	inline vfloat max(vfloat a, vfloat b) { vfloat r = { vmaxnmq_f32(a.v, b.v) }; return r; }
+	inline vfloat floor(vfloat a) { vfloat r = { vrndmq_f32(a.v) }; return r; }
+	inline vint truncate(vfloat a) { vint r = { vcvtq_s32_f32(a.v) }; return r; }
+	inline vfloat toFloat(vint a) { vfloat r = { vcvtq_f32_s32(a.v) }; return r; }
+	inline vfloat asFloat(vint a) { vfloat r = { vreinterpretq_f32_s32(a.v) }; return r; }
+	inline vint asInt(vfloat a) { vint r = { vreinterpretq_s32_f32(a.v) }; return r; }
+	inline vint operator+(vint a, vint b) { vint r = { vaddq_s32(a.v, b.v) }; return r; }
+	inline vint operator-(vint a, vint b) { vint r = { vsubq_s32(a.v, b.v) }; return r; }
+	inline vint operator&(vint a, vint b) { vint r = { vandq_s32(a.v, b.v) }; return r; }
+	inline vint operator^(vint a, vint b) { vint r = { veorq_s32(a.v, b.v) }; return r; }
+	// a & ~b
+	inline vint andNot(vint a, vint b) { vint r = { vbicq_s32(a.v, b.v) }; return r; }
+	template <int N> inline vint shiftLeft(vint a) { vint r = { vshlq_n_s32(a.v, N) }; return r; }
+	inline vint equal(vint a, vint b) { vint r = { vreinterpretq_s32_u32(vceqq_s32(a.v, b.v)) }; return r; }
+	inline vint equal(vfloat a, vfloat b) { vint r = { vreinterpretq_s32_u32(vceqq_f32(a.v, b.v)) }; return r; }
+	inline vfloat select(vint mask, vfloat a, vfloat b) { vfloat r = { vbslq_f32(vreinterpretq_u32_s32(mask.v), a.v, b.v) }; return r; }
+#else
+	const int WIDTH = 1;
+	struct vfloat { float v; };
+	struct vint { int32_t v; };
+
+	inline vfloat set1(float a) { vfloat r = { a }; return r; }
+	inline vint set1i(int32_t a) { vint r = { a }; return r; }
+	inline vfloat ramp() { vfloat r = { 0.0f }; return r; }
+	inline vfloat load(const float* p) { vfloat r = { *p }; return r; }
+	inline void store(float* p, vfloat a) { *p = a.v; }
+	inline void storei(int32_t* p, vint a) { *p = a.v; }
+	inline vfloat operator+(vfloat a, vfloat b) { vfloat r = { a.v + b.v }; return r; }
+	inline vfloat operator-(vfloat a, vfloat b) { vfloat r = { a.v - b.v }; return r; }
+	inline vfloat operator*(vfloat a, vfloat b) { vfloat r = { a.v * b.v }; return r; }
+	inline vfloat operator/(vfloat a, vfloat b) { vfloat r = { a.v / b.v }; return r; }
+	inline vfloat sqrt(vfloat a) { vfloat r = { std::sqrt(a.v) }; return r; }
+	inline vfloat min(vfloat a, vfloat b) { vfloat r = { a.v < b.v ? a.v : b.v }; return r; }
+	inline vfloat max(vfloat a, vfloat b) { vfloat r = { a.v > b.v ? a.v : b.v }; return r; }
+	inline vfloat floor(vfloat a) { vfloat r = { std::floor(a.v) }; return r; }
+	inline vint truncate(vfloat a) { vint r = { (int32_t)a.v }; return r; }
+	inline vfloat toFloat(vint a) { vfloat r = { (float)a.v }; return r; }
+	inline vfloat asFloat(vint a) { vfloat r; std::memcpy(&r.v, &a.v, sizeof(float)); return r; }
+	inline vint asInt(vfloat a) { vint r; std::memcpy(&r.v, &a.v, sizeof(float)); return r; }
+	inline vint operator+(vint a, vint b) { vint r = { (int32_t)((uint32_t)a.v + (uint32_t)b.v) }; return r; }
+	inline vint operator-(vint a, vint b) { vint r = { (int32_t)((uint32_t)a.v - (uint32_t)b.v) }; return r; }
+	inline vint operator&(vint a, vint b) { vint r = { a.v & b.v }; return r; }
+	inline vint operator^(vint a, vint b) { vint r = { a.v ^ b.v }; return r; }
+	// a & ~b
+	inline vint andNot(vint a, vint b) { vint r = { a.v & ~b.v }; return r; }
+	template <int N> inline vint shiftLeft(vint a) { vint r = { (int32_t)((uint32_t)a.v << N) }; return r; }
+	inline vint equal(vint a, vint b) { vint r = { a.v == b.v ? -1 : 0 }; return r; }
+	inline vint equal(vfloat a, vfloat b) { vint r = { a.v == b.v ? -1 : 0 }; return r; }
+	inline vfloat select(vint mask, vfloat a, vfloat b) { return mask.v ? a : b; }
+#endif
+
+	const int32_t SIGN_MASK = (int32_t)0x80000000u;
+
+	inline vfloat abs(vfloat a)
+	{
+		return asFloat(andNot(asInt(a), set1i(SIGN_MASK)));
+	}
+
+	// Cephes style sine/cosine: reduce to [-pi/4, pi/4] around the nearest multiple of pi/2 and
+	// evaluate the minimax polynomial of whichever of sin/cos lands in that octant.
+	// Accurate to a few ulp for |x| below about 8192
+	inline void sincos(vfloat x, vfloat& s, vfloat& c)
+	{
+		vint signSin = asInt(x) & set1i(SIGN_MASK);
+		x = abs(x);
+
+		// octant of x, rounded up to an even number so the remainder is centered on 0
+		vint j = truncate(x * set1(1.27323954473516f));
+		j = andNot(j + set1i(1), set1i(1));
+		vfloat y = toFloat(j);
+
+		// subtract y * pi/4 in three parts to keep the remainder precise
+		x = ((x - y * set1(0.78515625f)) - y * set1(2.4187564849853515625e-4f)) - y * set1(3.77489497744594108e-8f);
+
+		vint swapSin = shiftLeft<29>(j & set1i(4));
+		vint swapCos = shiftLeft<29>(andNot(set1i(4), j - set1i(2)));
+		vint useSinPoly = equal(j & set1i(2), set1i(0));
+
+		vfloat z = x * x;
+		vfloat cosPoly = ((set1(2.443315711809948e-5f) * z - set1(1.388731625493765e-3f)) * z + set1(4.166664568298827e-2f)) * z * z
+			- z * set1(0.5f) + set1(1.0f);
+		vfloat sinPoly = ((set1(-1.9515295891e-4f) * z + set1(8.3321608736e-3f)) * z - set1(1.6666654611e-1f)) * z * x + x;
+
+		s = asFloat(asInt(select(useSinPoly, sinPoly, cosPoly)) ^ swapSin ^ signSin);
+		c = asFloat(asInt(select(useSinPoly, cosPoly, sinPoly)) ^ swapCos);
+	}
+
+	inline vfloat sin(vfloat x)
+	{
+		vfloat s, c;
+		sincos(x, s, c);
+		return s;
+	}
+
+	inline vfloat cos(vfloat x)
+	{
+		vfloat s, c;
+		sincos(x, s, c);
+		return c;
+	}
+
+	// Cephes style exponential: e^x = 2^n * e^r with |r| <= ln(2)/2, e^r from a polynomial and
+	// 2^n assembled directly in the exponent bits. Inputs are clamped to the finite float range
+	inline vfloat exp(vfloat x)
+	{
+		x = min(x, set1(88.3762626647949f));
+		x = max(x, set1(-87.3365478515625f));
+
+		vfloat n = floor(x * set1(1.44269504088896341f) + set1(0.5f));
+		x = x - n * set1(0.693359375f) - n * set1(-2.12194440e-4f);
+
+		vfloat z = x * x;
+		vfloat y = set1(1.9875691500e-4f);
+		y = y * x + set1(1.3981999507e-3f);
+		y = y * x + set1(8.3334519073e-3f);
+		y = y * x + set1(4.1665795894e-2f);
+		y = y * x + set1(1.6666665459e-1f);
+		y = y * x + set1(5.0000001201e-1f);
+		y = y * z + x + set1(1.0f);
+
+		vfloat pow2n = asFloat(shiftLeft<23>(truncate(n) + set1i(127)));
+		return y * pow2n;
+	}
+
+	// Zeroes the NaN lanes of a, NaN is the only value not equal to itself
+	inline vfloat zeroNaN(vfloat a)
+	{
+		return asFloat(asInt(a) & equal(a, a));
+	}
+
+	// Packs unit vectors as GL_INT_2_10_10_10_REV: x, y and z as 10-bit signed normalized integers
+	// from the lowest bits up, and w = 0. Components are clamped to [-1, 1] and rounded to nearest,
+	// NaN components become 0 like in the scalar packNormal (max would turn them into -1)
+	inline vint packNormal(vfloat x, vfloat y, vfloat z)
+	{
+		x = zeroNaN(x);
+		y = zeroNaN(y);
+		z = zeroNaN(z);
+		const vfloat one = set1(1.0f);
+		const vfloat minusOne = set1(-1.0f);
+		const vfloat scale = set1(511.0f);
+		const vfloat half = set1(0.5f);
+		const vint bits = set1i(0x3FF);
+		vint ix = truncate(floor(min(max(x, minusOne), one) * scale + half)) & bits;
+		vint iy = truncate(floor(min(max(y, minusOne), one) * scale + half)) & bits;
+		vint iz = truncate(floor(min(max(z, minusOne), one) * scale + half)) & bits;
+		// the fields do not overlap, so adding them is an or
+		return ix + shiftLeft<10>(iy) + shiftLeft<20>(iz);
+	}
+}
+#endif
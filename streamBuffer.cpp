@@ -0,0 +1,137 @@
+#include"streamBuffer.h"
+#include"glExtensions.h"
+
+// Regions start on this many bytes, a multiple of every vertex attribute size
+static const std::size_t STREAM_ALIGNMENT = 256;
+
+// Constructor that defers creating the buffer until the first Begin
+StreamBuffer::StreamBuffer() : VBO(0), persistent(false), mapped(nullptr), regionSize(0), writeSize(0), region(0)
+{
+	for (int i = 0; i < STREAM_REGIONS; i++)
+		fences[i] = 0;
+}
+
+// Creates the buffer with regions of at least size bytes
+void StreamBuffer::Allocate(std::size_t size)
+{
+	Delete();
+	regionSize = (size + STREAM_ALIGNMENT - 1) / STREAM_ALIGNMENT * STREAM_ALIGNMENT;
+	persistent = GLAD_GL_ARB_buffer_storage != 0;
+
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	if (persistent)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, regionSize * STREAM_REGIONS, nullptr, flags);
+		mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, regionSize * STREAM_REGIONS, flags);
+		if (mapped == nullptr)
+		{
+			// Some drivers advertise the extension but refuse the mapping, fall back to uploads
+			glDeleteBuffers(1, &VBO);
+			glGenBuffers(1, &VBO);
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			persistent = false;
+		}
+	}
+	if (!persistent)
+	{
+		glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+		staging.resize(regionSize);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	region = 0;
+}
+
+void StreamBuffer::WaitForRegion(int index)
+{
+	if (fences[index] == 0)
+		return;
+	// Flush on the first try so the fence is sure to be signalled eventually
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	for (;;)
+	{
+		GLenum result = glClientWaitSync(fences[index], flags, 1000000000);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+			break;
+		flags = 0;
+	}
+	glDeleteSync(fences[index]);
+	fences[index] = 0;
+}
+
+// Returns memory for size bytes of this frame's data, waiting for the GPU to finish with the region if needed
+void* StreamBuffer::Begin(std::size_t size)
+{
+	if (VBO == 0 || size > regionSize)
+		Allocate(size);
+	writeSize = size;
+
+	if (!persistent)
+		return staging.data();
+
+	region = (region + 1) % STREAM_REGIONS;
+	// With three regions this only blocks when the GPU is more than two frames behind
+	WaitForRegion(region);
+	return mapped + region * regionSize;
+}
+
+// Makes the data written since Begin visible to the GPU
+void StreamBuffer::End()
+{
+	// Coherent mapping: writes are visible to commands issued from now on
+	if (persistent)
+		return;
+
+	// Orphan the old storage so the driver does not wait for draws still reading it
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, writeSize, staging.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Byte offset of this frame's data in the Vertex Buffer
+std::size_t StreamBuffer::Offset() const
+{
+	return persistent ? region * regionSize : 0;
+}
+
+// Marks the end of the draws reading this frame's data, call after the last one
+void StreamBuffer::Fence()
+{
+	if (!persistent)
+		return;
+	if (fences[region] != 0)
+		glDeleteSync(fences[region]);
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+// True when the buffer is persistently mapped
+bool StreamBuffer::IsPersistent() const
+{
+	return persistent;
+}
+
+// Deletes the Vertex Buffer and its fences
+void StreamBuffer::Delete()
+{
+	// GL keeps the storage alive until pending draws are done, the fences are no longer needed
+	for (int i = 0; i < STREAM_REGIONS; i++)
+	{
+		if (fences[i] != 0)
+			glDeleteSync(fences[i]);
+		fences[i] = 0;
+	}
+	if (VBO != 0)
+	{
+		if (mapped != nullptr)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &VBO);
+	}
+	VBO = 0;
+	mapped = nullptr;
+}
@@ -0,0 +1,52 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include<glad/glad.h>
+#include<cstddef>
+#include<vector>
+
+// Number of regions the GPU can be reading while the CPU writes the next one
+const int STREAM_REGIONS = 3;
+
+// Vertex Buffer for data rewritten every frame. With GL_ARB_buffer_storage it is mapped once,
+// persistently and coherently, and split into STREAM_REGIONS regions guarded by fences, so the
+// CPU writes straight into memory the GPU reads without copies or driver stalls. Without it the
+// data is written to a staging copy and uploaded by orphaning the buffer and glBufferSubData
+class StreamBuffer
+{
+public:
+	// Reference ID of the Vertex Buffer, changes when the buffer has to grow
+	GLuint VBO;
+
+	// Constructor that defers creating the buffer until the first Begin
+	StreamBuffer();
+
+	// Returns memory for size bytes of this frame's data, waiting for the GPU to finish with the region if needed
+	void* Begin(std::size_t size);
+	// Makes the data written since Begin visible to the GPU
+	void End();
+	// Byte offset of this frame's data in the Vertex Buffer
+	std::size_t Offset() const;
+	// Marks the end of the draws reading this frame's data, call after the last one
+	void Fence();
+	// True when the buffer is persistently mapped
+	bool IsPersistent() const;
+	// Deletes the Vertex Buffer and its fences
+	void Delete();
+
+private:
+	// Creates the buffer with regions of at least size bytes
+	void Allocate(std::size_t size);
+	void WaitForRegion(int index);
+
+	bool persistent;
+	unsigned char* mapped;
+	// Bytes per region, and bytes written in the current one
+	std::size_t regionSize;
+	std::size_t writeSize;
+	int region;
+	GLsync fences[STREAM_REGIONS];
+	// Copy of the frame's data when the buffer cannot be mapped persistently
+	std::vector<unsigned char> staging;
+};
+#endif
@@ -0,0 +1,161 @@
+#version 330 core
+// Variant of default.vert that evaluates the built-in functions itself over a static grid,
+// so changing a parameter only costs a uniform write instead of rebuilding the mesh.
+// FeedbackSurface also captures its outputs with transform feedback to generate meshes on GL 3.3
+
+out vec3 fragPos;
+// height alone, captured for compact grid meshes
+out float height;
+// position and normal in world space for the lighting in default.frag. The normal is zero
+// unless generateNormals is set, default.frag then shades the faces flat
+out vec3 worldPos;
+out vec3 fragNormal;
+// the normal packed like packNormal in surfaceKernels.h, captured for the Normal Buffer
+flat out uint packedNormal;
+// row and column of the vertex in the whole grid, the cell edges of the wireframe lie at whole numbers
+out vec2 gridCoord;
+// read by default.frag, only quantized meshes have samples without a height
+out float missingHeight;
+
+// camera matrices shared by every program, see cameraBlock.h
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	vec4 cameraPosition;
+	vec4 viewport;
+};
+uniform mat4 model;
+
+// grid layout, x and z follow from the vertex index
+uniform vec2 gridOrigin;
+uniform float gridStep;
+// first row and column of the chunk being drawn, its columns and the buffer offset of its first vertex
+uniform ivec2 gridFirst;
+uniform int gridColumns;
+uniform int gridBaseVertex;
+// samples of the torus, only captured by FeedbackSurface
+uniform int vertexCount;
+// set by FeedbackSurface. Drawing the grid directly skips the four extra evaluations of the normals
+uniform bool generateNormals;
+
+// function to plot and its parameters, named after the globals in main.cpp
+uniform int surfaceChoice;
+uniform float time;
+uniform float wave_amplitude;
+uniform float wave_length;
+uniform float ripple_Strength;
+uniform float ripple_frequency;
+uniform float radius_to_center;
+uniform float tube_radius;
+uniform float fence_height;
+uniform float stair_distance;
+uniform float letterO_height;
+uniform float letterO_size;
+uniform float top_hat_height;
+uniform float bump_height;
+
+float sombrero(float x, float z)
+{
+	float r = sqrt(x * x + z * z) / wave_length;
+	return wave_amplitude * (sin(r) / r);
+}
+float ripple(float x, float z)
+{
+	return ripple_Strength * sin(time * ripple_frequency + x / 5.0 + z / 5.0);
+}
+float intersectingFences(float x, float z)
+{
+	float x5 = x * 5.0;
+	float z5 = z * 5.0;
+	// multiply by the inverse so huge exponents give 0 instead of dividing by infinity
+	return fence_height * exp(-(x5 * x5 * z5 * z5));
+}
+float stairs(float x, float z)
+{
+	return sign(x - stair_distance + abs(z * 2.0)) / 0.5 + sign(x - 0.5 + abs(z * 2.0));
+}
+float letterO(float x, float z)
+{
+	float r2 = x * x + z * z;
+	return (-sign(20.0 - r2) + sign(20.0 - r2 / abs(letterO_size))) / abs(letterO_height);
+}
+float topHat(float x, float z)
+{
+	float r2 = x * x + z * z;
+	return (sign(20.0 - r2) + sign(20.0 - r2 / 3.0)) / abs(top_hat_height) - 1.0;
+}
+float bumps(float x, float z)
+{
+	return sin(6.0 * x) * cos(6.0 * z) / abs(bump_height);
+}
+
+float surfaceHeight(float x, float z)
+{
+	if (surfaceChoice == 1)
+		return sombrero(x, z);
+	if (surfaceChoice == 2)
+		return ripple(x, z);
+	if (surfaceChoice == 4)
+		return intersectingFences(x, z);
+	if (surfaceChoice == 5)
+		return stairs(x, z);
+	if (surfaceChoice == 6)
+		return letterO(x, z);
+	if (surfaceChoice == 7)
+		return topHat(x, z);
+	return bumps(x, z);
+}
+
+// Normal of the height field from central differences one sample away, like slopeNormals in surfaceKernels.cpp
+vec3 slopeNormal(float x, float z)
+{
+	float dx = surfaceHeight(x + gridStep, z) - surfaceHeight(x - gridStep, z);
+	float dz = surfaceHeight(x, z + gridStep) - surfaceHeight(x, z - gridStep);
+	return normalize(vec3(-dx, 2.0 * gridStep, -dz));
+}
+
+// Packs a unit normal as GL_INT_2_10_10_10_REV like packNormal in surfaceKernels.cpp, NaN components become 0
+uint packNormal(vec3 normal)
+{
+	normal = mix(clamp(normal, -1.0, 1.0), vec3(0.0), isnan(normal));
+	ivec3 snorm = ivec3(floor(normal * 511.0 + 0.5)) & 0x3FF;
+	return uint(snorm.x | (snorm.y << 10) | (snorm.z << 20));
+}
+
+void main()
+{
+	int index = gl_VertexID - gridBaseVertex;
+	int row = index / gridColumns;
+	int col = index - row * gridColumns;
+	gridCoord = vec2(gridFirst + ivec2(row, col));
+	vec3 pos;
+	vec3 normal = vec3(0.0);
+	if (surfaceChoice == 3)
+	{
+		// torus rings, the same parametrisation as buildTorus in main.cpp
+		float phi = 2.5 * 3.14159265 * float(row) / float(vertexCount / gridColumns);
+		float theta = 2.0 * 3.14159265 * float(col) / float(gridColumns);
+		float ring = radius_to_center + tube_radius * cos(theta);
+		pos = vec3(ring * cos(phi), tube_radius * sin(theta), ring * sin(phi));
+		normal = vec3(cos(theta) * cos(phi), sin(theta), cos(theta) * sin(phi));
+	}
+	else
+	{
+		float x = gridOrigin.x + float(gridFirst.x + row) * gridStep;
+		float z = gridOrigin.y + float(gridFirst.y + col) * gridStep;
+		pos = vec3(x, surfaceHeight(x, z), z);
+		if (generateNormals)
+			normal = slopeNormal(x, z);
+	}
+
+	vec4 world = model * vec4(pos, 1.0f);
+	gl_Position = viewProjection * world;
+	fragPos = pos;
+	height = pos.y;
+	worldPos = world.xyz;
+	fragNormal = mat3(model) * normal;
+	packedNormal = packNormal(normal);
+	missingHeight = 0.0;
+}
\ No newline at end of file
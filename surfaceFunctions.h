@@ -0,0 +1,110 @@
+#ifndef SURFACE_FUNCTIONS_H
+#define SURFACE_FUNCTIONS_H
+
+#include<cmath>
+
+// Height functors of the plotted surfaces. Each one carries a copy of its parameters so
+// GridMesher can inline it instead of reading the parameter globals for every vertex
+
+// signum function
+inline float signum(float v)
+{
+	return (v < 0.0f) ? -1.0f : ((v > 0.0f) ? 1.0f : 0.0f);
+}
+
+// Sombrero: sin(r) / r scaled by wave_amplitude and wave_length
+struct Sombrero
+{
+	float amplitude;
+	float length;
+
+	float operator()(float x, float z) const
+	{
+		float r = std::sqrt(x * x + z * z) / length;
+		return amplitude * (std::sin(r) / r);
+	}
+};
+
+// Ripple: travelling sine wave, time is sampled once per rebuild
+struct Ripple
+{
+	float strength;
+	float frequency;
+	float time;
+
+	float operator()(float x, float z) const
+	{
+		return strength * std::sin(time * frequency + x / 5.0f + z / 5.0f);
+	}
+};
+
+// Spatial part of the ripple: strength * sin(frequency * time + phase(x, z)), used by TimeBasis to
+// split the animation into cached bases
+struct RipplePhase
+{
+	float operator()(float x, float z) const
+	{
+		return x / 5.0f + z / 5.0f;
+	}
+};
+
+// Intersecting fences: ridges along both axes
+struct IntersectingFences
+{
+	float height;
+
+	float operator()(float x, float z) const
+	{
+		float x5 = x * 5.0f;
+		float z5 = z * 5.0f;
+		return height / std::exp(x5 * x5 * z5 * z5);
+	}
+};
+
+// Stairs: two steps along x bent by |z|
+struct Stairs
+{
+	float distance;
+
+	float operator()(float x, float z) const
+	{
+		return signum(x - distance + std::fabs(z * 2.0f)) / 0.5f + signum(x - 0.5f + std::fabs(z * 2.0f));
+	}
+};
+
+// Letter O: ring between two circles
+struct LetterO
+{
+	float height;
+	float size;
+
+	float operator()(float x, float z) const
+	{
+		float r2 = x * x + z * z;
+		return (-signum(20.0f - r2) + signum(20.0f - r2 / std::fabs(size))) / std::fabs(height);
+	}
+};
+
+// Top hat: two stacked discs
+struct TopHat
+{
+	float height;
+
+	float operator()(float x, float z) const
+	{
+		float r2 = x * x + z * z;
+		return (signum(20.0f - r2) + signum(20.0f - r2 / 3.0f)) / std::fabs(height) - 1.0f;
+	}
+};
+
+// Bumps: egg crate pattern
+struct Bumps
+{
+	float height;
+
+	float operator()(float x, float z) const
+	{
+		return std::sin(6.0f * x) * std::cos(6.0f * z) / std::fabs(height);
+	}
+};
+#endif
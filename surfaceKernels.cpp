@@ -0,0 +1,150 @@
+#include"surfaceKernels.h"
+#include"simdMath.h"
+
+#include<cmath>
+
+using namespace simd;
+
+// Runs kernel(z) for WIDTH consecutive samples at a time. The last partial vector is computed in
+// full and only the valid lanes are copied out, so every sample goes through the same code
+template <typename Kernel>
+static void forEachBatch(float originZ, float step, int firstCol, int count, float* heights, const Kernel& kernel)
+{
+	const vfloat lanes = ramp();
+	const vfloat zStep = set1(step);
+	const vfloat zOrigin = set1(originZ);
+
+	int i = 0;
+	for (; i + WIDTH <= count; i += WIDTH)
+	{
+		vfloat col = set1((float)(firstCol + i)) + lanes;
+		store(heights + i, kernel(zOrigin + col * zStep));
+	}
+	if (i < count)
+	{
+		float tail[WIDTH];
+		vfloat col = set1((float)(firstCol + i)) + lanes;
+		store(tail, kernel(zOrigin + col * zStep));
+		for (int j = 0; i + j < count; j++)
+			heights[i + j] = tail[j];
+	}
+}
+
+// Rounds one component to a 10-bit signed normalized integer
+static uint32_t packSnorm10(float value)
+{
+	if (!(value == value))
+		return 0;
+	value = value > 1.0f ? 1.0f : (value < -1.0f ? -1.0f : value);
+	return (uint32_t)(int32_t)std::floor(value * 511.0f + 0.5f) & 0x3FF;
+}
+
+// Packs a unit normal as GL_INT_2_10_10_10_REV like simd::packNormal, NaN components become 0
+uint32_t packNormal(float x, float y, float z)
+{
+	return packSnorm10(x) | (packSnorm10(y) << 10) | (packSnorm10(z) << 20);
+}
+
+// Writes the packed normals of a row of count samples from central differences of their neighbours.
+// above, row and below are the heights of the previous, current and next row, each with one more
+// sample on either side: indices -1 to count are read. step is the distance between samples
+void slopeNormals(const float* above, const float* row, const float* below, int count, float step, uint32_t* normals)
+{
+	// the normal of the slope (dx, dz) over two steps is (-dx, 2 * step, -dz) before normalizing
+	const float twoStep = 2.0f * step;
+	const vfloat up = set1(twoStep);
+	const vfloat up2 = up * up;
+	const vfloat zero = set1(0.0f);
+	const vfloat one = set1(1.0f);
+
+	int i = 0;
+	for (; i + WIDTH <= count; i += WIDTH)
+	{
+		vfloat dx = load(below + i) - load(above + i);
+		vfloat dz = load(row + i + 1) - load(row + i - 1);
+		vfloat inverseLength = one / sqrt(dx * dx + up2 + dz * dz);
+		storei((int32_t*)(normals + i), packNormal((zero - dx) * inverseLength, up * inverseLength, (zero - dz) * inverseLength));
+	}
+	for (; i < count; i++)
+	{
+		float dx = below[i] - above[i];
+		float dz = row[i + 1] - row[i - 1];
+		float inverseLength = 1.0f / std::sqrt(dx * dx + twoStep * twoStep + dz * dz);
+		normals[i] = packNormal(-dx * inverseLength, twoStep * inverseLength, -dz * inverseLength);
+	}
+}
+
+void evaluateRow(const Sombrero& heightFn, float x, float originZ, float step, int firstCol, int count, float* heights)
+{
+	const vfloat x2 = set1(x * x);
+	const vfloat amplitude = set1(heightFn.amplitude);
+	const vfloat length = set1(heightFn.length);
+	forEachBatch(originZ, step, firstCol, count, heights, [&](vfloat z)
+	{
+		vfloat r = sqrt(x2 + z * z) / length;
+		return amplitude * (simd::sin(r) / r);
+	});
+}
+
+void evaluateRow(const Ripple& heightFn, float x, float originZ, float step, int firstCol, int count, float* heights)
+{
+	// everything but the z term is constant along a row
+	const vfloat phase = set1(heightFn.time * heightFn.frequency + x / 5.0f);
+	const vfloat strength = set1(heightFn.strength);
+	const vfloat fifth = set1(5.0f);
+	forEachBatch(originZ, step, firstCol, count, heights, [&](vfloat z)
+	{
+		return strength * simd::sin(phase + z / fifth);
+	});
+}
+
+void evaluateRow(const IntersectingFences& heightFn, float x, float originZ, float step, int firstCol, int count, float* heights)
+{
+	const float x5 = x * 5.0f;
+	const vfloat x25 = set1(x5 * x5);
+	const vfloat height = set1(heightFn.height);
+	const vfloat five = set1(5.0f);
+	forEachBatch(originZ, step, firstCol, count, heights, [&](vfloat z)
+	{
+		vfloat z5 = z * five;
+		return height / simd::exp(x25 * z5 * z5);
+	});
+}
+
+void evaluateRow(const Bumps& heightFn, float x, float originZ, float step, int firstCol, int count, float* heights)
+{
+	// sin(6x) / |height| is the same for the whole row
+	const vfloat rowScale = set1(std::sin(6.0f * x) / std::fabs(heightFn.height));
+	const vfloat six = set1(6.0f);
+	forEachBatch(originZ, step, firstCol, count, heights, [&](vfloat z)
+	{
+		return rowScale * simd::cos(six * z);
+	});
+}
+
+void accumulateBounds(const float* heights, int count, HeightBounds& bounds)
+{
+	// min/max return their second operand when the first is NaN (see simdMath.h), so NaN samples never get in
+	vfloat low = set1(bounds.min);
+	vfloat high = set1(bounds.max);
+	int i = 0;
+	for (; i + WIDTH <= count; i += WIDTH)
+	{
+		vfloat h = load(heights + i);
+		low = min(h, low);
+		high = max(h, high);
+	}
+
+	float lanes[WIDTH];
+	store(lanes, low);
+	for (int j = 0; j < WIDTH; j++)
+		bounds.min = lanes[j] < bounds.min ? lanes[j] : bounds.min;
+	store(lanes, high);
+	for (int j = 0; j < WIDTH; j++)
+		bounds.max = lanes[j] > bounds.max ? lanes[j] : bounds.max;
+	for (; i < count; i++)
+	{
+		bounds.min = heights[i] < bounds.min ? heights[i] : bounds.min;
+		bounds.max = heights[i] > bounds.max ? heights[i] : bounds.max;
+	}
+}
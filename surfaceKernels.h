@@ -0,0 +1,60 @@
+#ifndef SURFACE_KERNELS_H
+#define SURFACE_KERNELS_H
+
+#include<cfloat>
+#include<stdint.h>
+
+#include"surfaceFunctions.h"
+
+// Smallest and largest height of a set of samples, NaN samples are left out
+struct HeightBounds
+{
+	float min;
+	float max;
+
+	// Bounds of no samples at all
+	static HeightBounds Empty()
+	{
+		HeightBounds bounds = { FLT_MAX, -FLT_MAX };
+		return bounds;
+	}
+	bool IsEmpty() const
+	{
+		return min > max;
+	}
+	// Widens the bounds to include other
+	void Merge(const HeightBounds& other)
+	{
+		min = other.min < min ? other.min : min;
+		max = other.max > max ? other.max : max;
+	}
+};
+
+// Widens bounds to include heights[0, count), run on each row while it is still in cache
+void accumulateBounds(const float* heights, int count, HeightBounds& bounds);
+
+// Packs a unit normal as GL_INT_2_10_10_10_REV like simd::packNormal, NaN components become 0
+uint32_t packNormal(float x, float y, float z);
+// Writes the packed normals of a row of count samples from central differences of their neighbours.
+// above, row and below are the heights of the previous, current and next row, each with one more
+// sample on either side: indices -1 to count are read. step is the distance between samples
+void slopeNormals(const float* above, const float* row, const float* below, int count, float step, uint32_t* normals);
+
+// Batch evaluation of a height functor along one grid row:
+// heights[i] = heightFn(x, originZ + (firstCol + i) * step) for i in [0, count)
+
+// Fallback for functors without a batch kernel, one call per sample
+template <typename HeightFn>
+inline void evaluateRow(const HeightFn& heightFn, float x, float originZ, float step, int firstCol, int count, float* heights)
+{
+	for (int i = 0; i < count; i++)
+		heights[i] = heightFn(x, originZ + (firstCol + i) * step);
+}
+
+// SIMD kernels (simdMath.h) evaluating 4 or 8 samples per instruction with polynomial sin/cos/exp,
+// approximating the functor's own operator()
+void evaluateRow(const Sombrero& heightFn, float x, float originZ, float step, int firstCol, int count, float* heights);
+void evaluateRow(const Ripple& heightFn, float x, float originZ, float step, int firstCol, int count, float* heights);
+void evaluateRow(const IntersectingFences& heightFn, float x, float originZ, float step, int firstCol, int count, float* heights);
+void evaluateRow(const Bumps& heightFn, float x, float originZ, float step, int firstCol, int count, float* heights);
+#endif
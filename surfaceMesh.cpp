@@ -0,0 +1,274 @@
+#include"surfaceMesh.h"
+
+bool operator==(const SurfaceKey& a, const SurfaceKey& b)
+{
+	if (a.choice != b.choice || a.gridSize != b.gridSize || a.samples != b.samples || a.layout != b.layout || a.heightFormat != b.heightFormat
+		|| a.generator != b.generator || a.time != b.time)
+		return false;
+	for (int i = 0; i < SURFACE_PARAM_COUNT; i++)
+	{
+		if (a.params[i] != b.params[i])
+			return false;
+	}
+	return true;
+}
+
+bool operator!=(const SurfaceKey& a, const SurfaceKey& b)
+{
+	return !(a == b);
+}
+
+// Sets the uniforms the vertex shaders rebuild x and z of a grid chunk from
+void setGridUniforms(Shader& shader, const GridSpec& grid, GLint baseVertex)
+{
+	shader.SetVec2("gridOrigin", grid.originX, grid.originZ);
+	shader.SetFloat("gridStep", grid.step);
+	shader.SetIVec2("gridFirst", grid.firstRow, grid.firstCol);
+	shader.SetInt("gridColumns", grid.cols);
+	shader.SetInt("gridBaseVertex", baseVertex);
+}
+
+// Constructor that generates the buffer objects of the mesh
+SurfaceMesh::SurfaceMesh() : compact(false), encoding(), streaming(false), boundTopology(nullptr), drawnIndices(0), drawnChunks(0), cachedKey(), hasData(false)
+{
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &NBO);
+
+	// Both layouts read the same buffer, only the one in use is enabled. Normals always come from their own buffer
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+	glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+	glBindBuffer(GL_ARRAY_BUFFER, NBO);
+	setNormalAttribute(0);
+	glEnableVertexAttribArray(2);
+	glBindVertexArray(0);
+}
+
+// Returns true when the uploaded mesh was not built for the given key
+bool SurfaceMesh::IsStale(const SurfaceKey& key) const
+{
+	return !hasData || cachedKey != key;
+}
+
+// Uploads one encoded height and one packed normal per sample of every chunk, x and z are rebuilt from gl_VertexID in the vertex shader.
+// chunkBounds holds the height bounds of each chunk
+void SurfaceMesh::UploadHeights(const SurfaceKey& key, const void* heights, const uint32_t* normals, const HeightEncoding& heightEncoding, const ChunkedGrid& heightGrid, const HeightBounds* chunkBounds, GridTopologyRegistry& topologies)
+{
+	compact = true;
+	encoding = heightEncoding;
+	SetChunks(heightGrid, (GridLayout)key.layout, chunkBounds, topologies);
+	Upload(key, heights, heightGrid.vertexCount * heightSize(encoding.format), normals, heightGrid.vertexCount, GL_STATIC_DRAW);
+}
+
+// Sizes the Vertex Buffer for float heights, and the Normal Buffer for normals, of every chunk that the GPU writes. Returns the Vertex Buffer
+GLuint SurfaceMesh::ReserveHeights(const SurfaceKey& key, const ChunkedGrid& heightGrid, GridTopologyRegistry& topologies)
+{
+	compact = true;
+	encoding = encodeHeightsAs(HEIGHT_FLOAT, HeightBounds::Empty());
+	// The heights stay on the GPU, the chunks are only bounded along x and z
+	SetChunks(heightGrid, (GridLayout)key.layout, nullptr, topologies);
+	// Respecifying the storage also orphans what earlier draws may still read
+	Upload(key, nullptr, heightGrid.vertexCount * sizeof(float), nullptr, heightGrid.vertexCount, GL_DYNAMIC_COPY);
+	return VBO;
+}
+
+// Sizes the Vertex and Normal Buffers for vertexCount positions and normals that the GPU writes, returns the Vertex Buffer
+GLuint SurfaceMesh::ReservePositions(const SurfaceKey& key, std::size_t vertexCount, const GridTopology& gridTopology)
+{
+	SetPositionChunk(gridTopology);
+	Upload(key, nullptr, vertexCount * 3 * sizeof(float), nullptr, vertexCount, GL_DYNAMIC_COPY);
+	return VBO;
+}
+
+// Returns memory for the heights of an animated surface, written straight into the stream buffer where possible.
+// Call EndStreamHeights once all heightCount heights of the format and their normals are written
+void* SurfaceMesh::BeginStreamHeights(std::size_t heightCount, HeightFormat format)
+{
+	return stream.Begin(heightCount * heightSize(format));
+}
+
+// Returns memory for the packed normals of the heights being streamed
+uint32_t* SurfaceMesh::BeginStreamNormals(std::size_t normalCount)
+{
+	return (uint32_t*)normalStream.Begin(normalCount * NORMAL_SIZE);
+}
+
+// Publishes the heights and normals written since BeginStreamHeights and BeginStreamNormals, chunkBounds holds the height bounds of each chunk
+void SurfaceMesh::EndStreamHeights(const SurfaceKey& key, const HeightEncoding& heightEncoding, const ChunkedGrid& heightGrid, const HeightBounds* chunkBounds, GridTopologyRegistry& topologies)
+{
+	stream.End();
+	normalStream.End();
+	compact = true;
+	encoding = heightEncoding;
+	SetChunks(heightGrid, (GridLayout)key.layout, chunkBounds, topologies);
+
+	// The attributes are pointed at this frame's regions, the two streams need not be laid out alike.
+	// This is redone every frame since a stream that grew may have been given its old buffer's name
+	BindHeights(stream.VBO, encoding.format, stream.Offset());
+	BindNormals(normalStream.VBO, normalStream.Offset());
+	streaming = true;
+
+	cachedKey = key;
+	hasData = true;
+}
+
+// Makes one chunk per chunk of heightGrid, whose boxes have unknown heights when chunkBounds is null
+void SurfaceMesh::SetChunks(const ChunkedGrid& heightGrid, GridLayout layout, const HeightBounds* chunkBounds, GridTopologyRegistry& topologies)
+{
+	chunks.clear();
+	for (std::size_t i = 0; i < heightGrid.chunks.size(); i++)
+	{
+		const GridSpec& chunkGrid = heightGrid.chunks[i];
+		BoundingBox box = chunkBox(chunkGrid, chunkBounds != nullptr ? chunkBounds[i] : HeightBounds::Empty());
+		MeshChunk chunk = { chunkGrid, &topologies.Get(chunkGrid.rows, chunkGrid.cols, layout), (GLint)heightGrid.offsets[i], box };
+		chunks.push_back(chunk);
+	}
+}
+
+// Makes the single chunk of a mesh of full positions drawn with gridTopology
+void SurfaceMesh::SetPositionChunk(const GridTopology& gridTopology)
+{
+	compact = false;
+	chunks.clear();
+	GridSpec grid = { 0.0f, 0.0f, 0.0f, gridTopology.rows, gridTopology.cols, 0, 0 };
+	// The torus is small and its extent is not tracked, it is never culled
+	MeshChunk chunk = { grid, &gridTopology, 0, BoundingBox::Everything() };
+	chunks.push_back(chunk);
+}
+
+// Points the height attribute at heights of the format starting offset bytes into the given buffer
+void SurfaceMesh::BindHeights(GLuint buffer, HeightFormat format, std::size_t offset)
+{
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	setHeightAttribute(format, offset);
+	glEnableVertexAttribArray(1);
+	glDisableVertexAttribArray(0);
+	glBindVertexArray(0);
+}
+
+// Points the normal attribute at normals starting offset bytes into the given buffer
+void SurfaceMesh::BindNormals(GLuint buffer, std::size_t offset)
+{
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	setNormalAttribute(offset);
+	glBindVertexArray(0);
+}
+
+// Uploads vertexCount full x, y, z positions and packed normals for surfaces that are not height fields
+void SurfaceMesh::UploadPositions(const SurfaceKey& key, const float* positions, const uint32_t* normals, std::size_t vertexCount, const GridTopology& gridTopology)
+{
+	SetPositionChunk(gridTopology);
+	Upload(key, positions, vertexCount * 3 * sizeof(float), normals, vertexCount, GL_STATIC_DRAW);
+}
+
+// Uploads freshly generated vertices and normals, or only sizes the buffers when they are null, and remembers the key they belong to
+void SurfaceMesh::Upload(const SurfaceKey& key, const void* vertices, std::size_t size, const uint32_t* normals, std::size_t vertexCount, GLenum usage)
+{
+	// Static data goes back into the mesh's own buffers
+	if (compact)
+		BindHeights(VBO, encoding.format, 0);
+	BindNormals(NBO, 0);
+	streaming = false;
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, size, vertices, usage);
+	glBindBuffer(GL_ARRAY_BUFFER, NBO);
+	glBufferData(GL_ARRAY_BUFFER, vertexCount * NORMAL_SIZE, normals, usage);
+	if (compact)
+	{
+		glDisableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+	}
+	else
+	{
+		glEnableVertexAttribArray(0);
+		glDisableVertexAttribArray(1);
+	}
+	glBindVertexArray(0);
+
+	cachedKey = key;
+	hasData = true;
+}
+
+// Draws the chunks of the uploaded mesh that may be inside the frustum, all of them when it is null,
+// setting the grid uniforms of the shader
+void SurfaceMesh::Draw(Shader& shader, const Frustum* frustum)
+{
+	drawnIndices = 0;
+	drawnChunks = 0;
+	if (chunks.empty())
+		return;
+
+	shader.SetInt("compactGrid", compact);
+	if (compact)
+	{
+		shader.SetFloat("heightScale", encoding.scale);
+		shader.SetFloat("heightBias", encoding.bias);
+		shader.SetInt("quantizedHeights", encoding.format == HEIGHT_UNORM16);
+	}
+
+	glBindVertexArray(VAO);
+	for (std::size_t i = 0; i < chunks.size(); i++)
+	{
+		// Meshes of positions need the grid uniforms too, the wireframe follows their rows and columns
+		const MeshChunk& chunk = chunks[i];
+		if (frustum != nullptr && !frustum->Intersects(chunk.box))
+			continue;
+		setGridUniforms(shader, chunk.grid, chunk.baseVertex);
+		// The Element Buffer binding is part of the Vertex Array state, chunks of the same size keep it
+		if (boundTopology != chunk.topology)
+		{
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.topology->EBO);
+			boundTopology = chunk.topology;
+		}
+		chunk.topology->Draw(chunk.baseVertex);
+		drawnIndices += chunk.topology->indexCount;
+		drawnChunks++;
+	}
+	glBindVertexArray(0);
+
+	// The regions just drawn from must not be rewritten before the GPU is done with them
+	if (streaming)
+	{
+		stream.Fence();
+		normalStream.Fence();
+	}
+}
+
+// Indices and chunks submitted by the last Draw
+std::size_t SurfaceMesh::IndexCount() const
+{
+	return drawnIndices;
+}
+
+std::size_t SurfaceMesh::DrawnChunks() const
+{
+	return drawnChunks;
+}
+
+// Adds up the vertex cache statistics of every chunk, before and after reordering
+void SurfaceMesh::CacheStats(VertexCacheStats& before, VertexCacheStats& after) const
+{
+	before = VertexCacheStats();
+	after = VertexCacheStats();
+	for (std::size_t i = 0; i < chunks.size(); i++)
+	{
+		before.Add(chunks[i].topology->cacheBefore);
+		after.Add(chunks[i].topology->cacheAfter);
+	}
+}
+
+// Deletes the buffer objects of the mesh
+void SurfaceMesh::Delete()
+{
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &NBO);
+	stream.Delete();
+	normalStream.Delete();
+}
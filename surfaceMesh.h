@@ -0,0 +1,141 @@
+#ifndef SURFACE_MESH_H
+#define SURFACE_MESH_H
+
+#include<glad/glad.h>
+#include<cstddef>
+#include<vector>
+
+#include"frustum.h"
+#include"gridChunks.h"
+#include"gridTopology.h"
+#include"heightFormat.h"
+#include"shaderClass.h"
+#include"streamBuffer.h"
+
+// Number of function parameters (wave_amplitude, wave_length, ...) stored in a SurfaceKey
+const int SURFACE_PARAM_COUNT = 12;
+
+// Where the vertices of a surface are generated
+enum SurfaceGenerator
+{
+	// GridMesher and buildTorus on the CPU, uploaded in any HeightFormat
+	GENERATE_CPU,
+	// surface.vert captured with transform feedback, any GL 3.3 context
+	GENERATE_FEEDBACK,
+	// surface.comp writing into a shader storage buffer, GL 4.3+
+	GENERATE_COMPUTE,
+	SURFACE_GENERATOR_COUNT
+};
+
+// Everything a generated surface depends on. The mesh is only regenerated when this changes
+struct SurfaceKey
+{
+	// Which function is plotted
+	int choice;
+	// Grid extent and samples along each axis
+	int gridSize;
+	int samples;
+	// GridLayout of the indices
+	int layout;
+	// HeightFormat of the Vertex Buffer
+	int heightFormat;
+	// SurfaceGenerator producing the vertices
+	int generator;
+	// Animation time, left at 0 for surfaces that do not depend on time
+	double time;
+	// Values of every parameter global
+	float params[SURFACE_PARAM_COUNT];
+};
+
+bool operator==(const SurfaceKey& a, const SurfaceKey& b);
+bool operator!=(const SurfaceKey& a, const SurfaceKey& b);
+
+// Sets the uniforms the vertex shaders rebuild x and z of a grid chunk from
+void setGridUniforms(Shader& shader, const GridSpec& grid, GLint baseVertex);
+
+// Part of a mesh drawn with one call, using the shared indices of its size
+struct MeshChunk
+{
+	// Samples of the chunk. Meshes of positions only fill in the rows and columns, for the wireframe
+	GridSpec grid;
+	const GridTopology* topology;
+	// Index of the first vertex of the chunk in the Vertex Buffer
+	GLint baseVertex;
+	// Box around the vertices of the chunk, tested against the view frustum before drawing it
+	BoundingBox box;
+};
+
+class SurfaceMesh
+{
+public:
+	// Reference IDs of the Vertex Array, Vertex Buffer and Normal Buffer
+	GLuint VAO;
+	GLuint VBO;
+	GLuint NBO;
+	// Chunks of the uploaded mesh, drawn one after another
+	std::vector<MeshChunk> chunks;
+	// True when the Vertex Buffer only holds heights of the samples of grid
+	bool compact;
+	// How those heights are stored
+	HeightEncoding encoding;
+
+	// Constructor that generates the buffer objects of the mesh
+	SurfaceMesh();
+
+	// Returns true when the uploaded mesh was not built for the given key
+	bool IsStale(const SurfaceKey& key) const;
+	// Uploads one encoded height and one packed normal per sample of every chunk, x and z are rebuilt from gl_VertexID in the vertex shader.
+	// chunkBounds holds the height bounds of each chunk
+	void UploadHeights(const SurfaceKey& key, const void* heights, const uint32_t* normals, const HeightEncoding& heightEncoding, const ChunkedGrid& heightGrid, const HeightBounds* chunkBounds, GridTopologyRegistry& topologies);
+	// Uploads vertexCount full x, y, z positions and packed normals for surfaces that are not height fields
+	void UploadPositions(const SurfaceKey& key, const float* positions, const uint32_t* normals, std::size_t vertexCount, const GridTopology& gridTopology);
+	// Sizes the Vertex Buffer for float heights, and the Normal Buffer for normals, of every chunk that the GPU writes. Returns the Vertex Buffer
+	GLuint ReserveHeights(const SurfaceKey& key, const ChunkedGrid& heightGrid, GridTopologyRegistry& topologies);
+	// Sizes the Vertex and Normal Buffers for vertexCount positions and normals that the GPU writes, returns the Vertex Buffer
+	GLuint ReservePositions(const SurfaceKey& key, std::size_t vertexCount, const GridTopology& gridTopology);
+	// Returns memory for the heights of an animated surface, written straight into the stream buffer where possible.
+	// Call EndStreamHeights once all heightCount heights of the format and their normals are written
+	void* BeginStreamHeights(std::size_t heightCount, HeightFormat format);
+	// Returns memory for the packed normals of the heights being streamed
+	uint32_t* BeginStreamNormals(std::size_t normalCount);
+	// Publishes the heights and normals written since BeginStreamHeights and BeginStreamNormals, chunkBounds holds the height bounds of each chunk
+	void EndStreamHeights(const SurfaceKey& key, const HeightEncoding& heightEncoding, const ChunkedGrid& heightGrid, const HeightBounds* chunkBounds, GridTopologyRegistry& topologies);
+	// Draws the chunks of the uploaded mesh that may be inside the frustum, all of them when it is null,
+	// setting the grid uniforms of the shader
+	void Draw(Shader& shader, const Frustum* frustum);
+	// Indices and chunks submitted by the last Draw
+	std::size_t IndexCount() const;
+	std::size_t DrawnChunks() const;
+	// Adds up the vertex cache statistics of every chunk, before and after reordering
+	void CacheStats(VertexCacheStats& before, VertexCacheStats& after) const;
+	// Deletes the buffer objects of the mesh
+	void Delete();
+
+private:
+	// Stores vertices and normals in the mesh's own buffers, or only sizes them when the data is null
+	void Upload(const SurfaceKey& key, const void* vertices, std::size_t size, const uint32_t* normals, std::size_t vertexCount, GLenum usage);
+	// Makes one chunk per chunk of heightGrid, whose boxes have unknown heights when chunkBounds is null
+	void SetChunks(const ChunkedGrid& heightGrid, GridLayout layout, const HeightBounds* chunkBounds, GridTopologyRegistry& topologies);
+	// Makes the single chunk of a mesh of full positions drawn with gridTopology
+	void SetPositionChunk(const GridTopology& gridTopology);
+	// Points the height attribute at heights of the format starting offset bytes into the given buffer
+	void BindHeights(GLuint buffer, HeightFormat format, std::size_t offset);
+	// Points the normal attribute at normals starting offset bytes into the given buffer
+	void BindNormals(GLuint buffer, std::size_t offset);
+
+	// Heights and normals of animated surfaces, rewritten every frame
+	StreamBuffer stream;
+	StreamBuffer normalStream;
+	// True when the heights and normals come from the stream buffers
+	bool streaming;
+
+	// Topology currently bound into the Vertex Array
+	const GridTopology* boundTopology;
+	// What the last Draw submitted
+	std::size_t drawnIndices;
+	std::size_t drawnChunks;
+	// Key the current buffer contents were generated for
+	SurfaceKey cachedKey;
+	bool hasData;
+};
+#endif
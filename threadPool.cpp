@@ -0,0 +1,153 @@
+#include"threadPool.h"
+
+// Constructor that starts without worker threads, everything runs on the calling thread
+ThreadPool::ThreadPool() : remaining(0), generation(0), stopping(false)
+{
+	queues.push_back(std::unique_ptr<Queue>(new Queue()));
+	queues[0]->head = 0;
+}
+
+ThreadPool::~ThreadPool()
+{
+	Stop();
+}
+
+// Number of threads that run blocks, including the thread calling ParallelFor
+int ThreadPool::ThreadCount() const
+{
+	return (int)queues.size();
+}
+
+// Stops the current workers and starts threadCount - 1 new ones
+void ThreadPool::Resize(int threadCount)
+{
+	if (threadCount < 1)
+		threadCount = 1;
+	Stop();
+
+	queues.clear();
+	for (int i = 0; i < threadCount; i++)
+	{
+		queues.push_back(std::unique_ptr<Queue>(new Queue()));
+		queues[i]->head = 0;
+	}
+
+	stopping = false;
+	for (int i = 1; i < threadCount; i++)
+		workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+}
+
+void ThreadPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		stopping = true;
+	}
+	jobReady.notify_all();
+	for (std::size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+	workers.clear();
+}
+
+void ThreadPool::Run(int count, int blockSize, TaskFn fn, const void* task)
+{
+	if (count <= 0)
+		return;
+	if (blockSize < 1)
+		blockSize = 1;
+
+	int blockCount = (count + blockSize - 1) / blockSize;
+	// Not worth waking anyone up for a single block
+	if (workers.empty() || blockCount == 1)
+	{
+		fn(task, 0, count);
+		return;
+	}
+
+	remaining = blockCount;
+	// Deal the blocks out round robin, stealing evens out whatever imbalance is left
+	int threadCount = (int)queues.size();
+	for (int i = 0; i < threadCount; i++)
+	{
+		Queue& queue = *queues[i];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.blocks.clear();
+		queue.head = 0;
+		for (int b = i; b < blockCount; b += threadCount)
+		{
+			int begin = b * blockSize;
+			int end = (begin + blockSize < count) ? begin + blockSize : count;
+			Block block = { fn, task, begin, end };
+			queue.blocks.push_back(block);
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		generation++;
+	}
+	jobReady.notify_all();
+
+	// The calling thread works through the blocks too instead of sitting idle
+	while (RunOneBlock(0))
+	{
+	}
+
+	std::unique_lock<std::mutex> lock(jobMutex);
+	jobDone.wait(lock, [this] { return remaining.load() == 0; });
+}
+
+void ThreadPool::WorkerLoop(int index)
+{
+	unsigned long long seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobReady.wait(lock, [&] { return stopping || generation != seen; });
+			if (stopping)
+				return;
+			seen = generation;
+		}
+		while (RunOneBlock(index))
+		{
+		}
+	}
+}
+
+// Runs one block from the thread's own queue or stolen from another, returns false when all are empty
+bool ThreadPool::RunOneBlock(int index)
+{
+	Block block;
+	bool found = false;
+	int threadCount = (int)queues.size();
+
+	for (int i = 0; i < threadCount && !found; i++)
+	{
+		Queue& queue = *queues[(index + i) % threadCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.head == queue.blocks.size())
+			continue;
+		if (i == 0)
+		{
+			// own queue: newest block first, it is the most likely one to still be in cache
+			block = queue.blocks.back();
+			queue.blocks.pop_back();
+		}
+		else
+		{
+			// someone else's queue: take the oldest block, the owner works from the other end
+			block = queue.blocks[queue.head++];
+		}
+		found = true;
+	}
+	if (!found)
+		return false;
+
+	block.fn(block.task, block.begin, block.end);
+	if (remaining.fetch_sub(1) == 1)
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		jobDone.notify_all();
+	}
+	return true;
+}
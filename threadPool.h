@@ -0,0 +1,74 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include<atomic>
+#include<condition_variable>
+#include<memory>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+// Persistent pool of worker threads. Each thread owns a queue of blocks, takes work from the
+// back of its own queue and steals from the front of the others once it runs dry
+class ThreadPool
+{
+public:
+	// Constructor that starts without worker threads, everything runs on the calling thread
+	ThreadPool();
+	~ThreadPool();
+
+	// Number of threads that run blocks, including the thread calling ParallelFor
+	int ThreadCount() const;
+	// Stops the current workers and starts threadCount - 1 new ones
+	void Resize(int threadCount);
+
+	// Calls task(begin, end) for consecutive blocks of [0, count) and returns once every block is done
+	template <typename Task>
+	void ParallelFor(int count, int blockSize, const Task& task)
+	{
+		Run(count, blockSize, &invoke<Task>, &task);
+	}
+
+private:
+	typedef void (*TaskFn)(const void* task, int begin, int end);
+
+	template <typename Task>
+	static void invoke(const void* task, int begin, int end)
+	{
+		(*static_cast<const Task*>(task))(begin, end);
+	}
+
+	struct Block
+	{
+		TaskFn fn;
+		const void* task;
+		int begin;
+		int end;
+	};
+
+	// Blocks waiting to run on one thread; thieves take them from head, the owner from the back
+	struct Queue
+	{
+		std::mutex mutex;
+		std::vector<Block> blocks;
+		std::size_t head;
+	};
+
+	void Run(int count, int blockSize, TaskFn fn, const void* task);
+	void WorkerLoop(int index);
+	// Runs one block from the thread's own queue or stolen from another, returns false when all are empty
+	bool RunOneBlock(int index);
+	void Stop();
+
+	std::vector<std::thread> workers;
+	// One queue per thread, index 0 belongs to the thread calling ParallelFor
+	std::vector<std::unique_ptr<Queue>> queues;
+
+	std::mutex jobMutex;
+	std::condition_variable jobReady;
+	std::condition_variable jobDone;
+	std::atomic<int> remaining;
+	unsigned long long generation;
+	bool stopping;
+};
+#endif
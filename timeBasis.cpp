@@ -0,0 +1,110 @@
+#include"timeBasis.h"
+
+#include<cmath>
+#include<mutex>
+
+#include"simdMath.h"
+
+using namespace simd;
+
+// Constructor that starts without any bases
+TimeBasis::TimeBasis() : gradientX(0.0f), gradientZ(0.0f), built(false)
+{
+}
+
+// Returns true when the bases were sampled over the same chunks as the given grid
+bool TimeBasis::Matches(const ChunkedGrid& grid) const
+{
+	return built && basisGrid.SameLayout(grid);
+}
+
+// Replaces phase[i] by its sine and writes its cosine to cosines[i]
+void TimeBasis::SinCosRow(float* phase, float* cosines, int count)
+{
+	int i = 0;
+	for (; i + WIDTH <= count; i += WIDTH)
+	{
+		vfloat s, c;
+		sincos(load(phase + i), s, c);
+		store(phase + i, s);
+		store(cosines + i, c);
+	}
+	for (; i < count; i++)
+	{
+		float p = phase[i];
+		phase[i] = std::sin(p);
+		cosines[i] = std::cos(p);
+	}
+}
+
+// Writes amplitude * sin(angle + phase) for every sample into heights, which must hold
+// vertexCount floats laid out like the chunked grid the bases were built for, and the packed
+// normal of every sample into normals. Returns the height bounds
+HeightBounds TimeBasis::Evaluate(float amplitude, double angle, float* heights, uint32_t* normals, ThreadPool& threads) const
+{
+	// the only transcendental calls of the frame, done in double so large times keep their precision
+	const float sinWeight = (float)(amplitude * std::cos(angle));
+	const float cosWeight = (float)(amplitude * std::sin(angle));
+	const float* sines = sinPhase.data();
+	const float* cosines = cosPhase.data();
+
+	HeightBounds bounds = HeightBounds::Empty();
+	std::mutex boundsMutex;
+	int count = (int)sinPhase.size();
+	threads.ParallelFor(count, GRID_BLOCK_SAMPLES, [&](int begin, int end)
+	{
+		const vfloat a = set1(sinWeight);
+		const vfloat b = set1(cosWeight);
+		const vfloat gx = set1(gradientX);
+		const vfloat gz = set1(gradientZ);
+		const vfloat zero = set1(0.0f);
+		const vfloat one = set1(1.0f);
+		// heights may be mapped GPU memory that is slow to read back, so the bounds are reduced in registers
+		vfloat low = set1(FLT_MAX);
+		vfloat high = set1(-FLT_MAX);
+		int i = begin;
+		for (; i + WIDTH <= end; i += WIDTH)
+		{
+			vfloat s = load(sines + i);
+			vfloat c = load(cosines + i);
+			vfloat h = a * s + b * c;
+			store(heights + i, h);
+			low = min(h, low);
+			high = max(h, high);
+
+			// amplitude * cos(angle + phase), the derivative of the height along the phase gradient
+			vfloat slope = a * c - b * s;
+			vfloat nx = slope * gx;
+			vfloat nz = slope * gz;
+			vfloat inverseLength = one / sqrt(nx * nx + one + nz * nz);
+			storei((int32_t*)(normals + i), packNormal((zero - nx) * inverseLength, inverseLength, (zero - nz) * inverseLength));
+		}
+
+		float lows[WIDTH];
+		float highs[WIDTH];
+		store(lows, low);
+		store(highs, high);
+		HeightBounds blockBounds = HeightBounds::Empty();
+		for (int j = 0; j < WIDTH; j++)
+		{
+			HeightBounds lane = { lows[j], highs[j] };
+			blockBounds.Merge(lane);
+		}
+		for (; i < end; i++)
+		{
+			float h = sinWeight * sines[i] + cosWeight * cosines[i];
+			heights[i] = h;
+			accumulateBounds(&h, 1, blockBounds);
+
+			float slope = sinWeight * cosines[i] - cosWeight * sines[i];
+			float nx = slope * gradientX;
+			float nz = slope * gradientZ;
+			float inverseLength = 1.0f / std::sqrt(nx * nx + 1.0f + nz * nz);
+			normals[i] = packNormal(-nx * inverseLength, inverseLength, -nz * inverseLength);
+		}
+
+		std::lock_guard<std::mutex> lock(boundsMutex);
+		bounds.Merge(blockBounds);
+	});
+	return bounds;
+}
@@ -0,0 +1,73 @@
+#ifndef TIME_BASIS_H
+#define TIME_BASIS_H
+
+#include<cstddef>
+#include<vector>
+
+#include"gridChunks.h"
+#include"threadPool.h"
+
+// Cached spatial bases of an animated surface of the form amplitude * sin(angle(t) + phase(x, z)).
+// Since sin(a + p) = sin(a) cos(p) + cos(a) sin(p), sin(phase) and cos(phase) are sampled once per
+// grid and every frame only takes a linear combination of them weighted by sin/cos of one angle.
+// The phase must be linear in x and z, as for a plane wave, so its gradient is the same everywhere and
+// the slope amplitude * cos(angle + phase) * gradient comes from the same bases
+class TimeBasis
+{
+public:
+	// Constructor that starts without any bases
+	TimeBasis();
+
+	// Returns true when the bases were sampled over the same chunks as the given grid
+	bool Matches(const ChunkedGrid& grid) const;
+
+	// Samples sin(phase) and cos(phase) at every sample of every chunk, PhaseFn is a linear functor phase(x, z)
+	template <typename PhaseFn>
+	void Build(const ChunkedGrid& grid, const PhaseFn& phaseFn, ThreadPool& threads)
+	{
+		basisGrid = grid;
+		gradientX = phaseFn(1.0f, 0.0f) - phaseFn(0.0f, 0.0f);
+		gradientZ = phaseFn(0.0f, 1.0f) - phaseFn(0.0f, 0.0f);
+		sinPhase.resize(grid.vertexCount);
+		cosPhase.resize(grid.vertexCount);
+
+		// one ParallelFor over the row blocks of every chunk
+		threads.ParallelFor((int)grid.blocks.size(), 1, [&](int begin, int end)
+		{
+			for (int b = begin; b < end; b++)
+			{
+				const ChunkRowBlock& block = grid.blocks[b];
+				const GridSpec& chunk = grid.chunks[block.chunk];
+				float* sines = &sinPhase[grid.offsets[block.chunk]];
+				float* cosines = &cosPhase[grid.offsets[block.chunk]];
+				for (int row = block.firstRow; row < block.lastRow; row++)
+				{
+					std::size_t first = (std::size_t)row * chunk.cols;
+					// the phase goes into the sines first and is replaced by its sine in place
+					const float x = chunk.originX + (chunk.firstRow + row) * chunk.step;
+					evaluateRow(phaseFn, x, chunk.originZ, chunk.step, chunk.firstCol, chunk.cols, sines + first);
+					SinCosRow(sines + first, cosines + first, chunk.cols);
+				}
+			}
+		});
+		built = true;
+	}
+
+	// Writes amplitude * sin(angle + phase) for every sample into heights, which must hold
+	// vertexCount floats laid out like the chunked grid the bases were built for, and the packed
+	// normal of every sample into normals. Returns the height bounds
+	HeightBounds Evaluate(float amplitude, double angle, float* heights, uint32_t* normals, ThreadPool& threads) const;
+
+private:
+	// Replaces phase[i] by its sine and writes its cosine to cosines[i]
+	static void SinCosRow(float* phase, float* cosines, int count);
+
+	ChunkedGrid basisGrid;
+	std::vector<float> sinPhase;
+	std::vector<float> cosPhase;
+	// Gradient of the phase along x and z
+	float gradientX;
+	float gradientZ;
+	bool built;
+};
+#endif
@@ -0,0 +1,221 @@
+#include"vertexCache.h"
+
+#include<cmath>
+#include<cstring>
+
+// Tuning of the vertex scores from Forsyth's article
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRIANGLE_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+// Average cache miss ratio: transformed vertices per triangle, 0.5 at best for large grids, 3 at worst
+double VertexCacheStats::ACMR() const
+{
+	return triangles > 0 ? (double)misses / triangles : 0.0;
+}
+
+// Average transform to vertex ratio: times each vertex is transformed, 1 at best
+double VertexCacheStats::ATVR() const
+{
+	return vertices > 0 ? (double)misses / vertices : 0.0;
+}
+
+// Adds the counts of another list, as when several chunks are drawn together
+void VertexCacheStats::Add(const VertexCacheStats& other)
+{
+	triangles += other.triangles;
+	vertices += other.vertices;
+	misses += other.misses;
+}
+
+// Simulates a FIFO cache of VERTEX_CACHE_SIZE entries over a triangle list of vertexCount vertices
+template <typename Index>
+VertexCacheStats measureVertexCache(const Index* indices, std::size_t indexCount, std::size_t vertexCount, FrameArena& scratch)
+{
+	VertexCacheStats stats = { indexCount / 3, 0, 0 };
+
+	// A vertex is cached while fewer than VERTEX_CACHE_SIZE misses happened since it was loaded
+	std::size_t* loadedAt = scratch.Allocate<std::size_t>(vertexCount);
+	bool* seen = scratch.Allocate<bool>(vertexCount);
+	std::memset(seen, 0, vertexCount * sizeof(bool));
+
+	for (std::size_t i = 0; i < indexCount; i++)
+	{
+		Index v = indices[i];
+		if (!seen[v])
+		{
+			seen[v] = true;
+			stats.vertices++;
+		}
+		else if (stats.misses - loadedAt[v] < (std::size_t)VERTEX_CACHE_SIZE)
+		{
+			continue;
+		}
+		loadedAt[v] = stats.misses;
+		stats.misses++;
+	}
+	return stats;
+}
+
+// Score of a vertex at cachePosition (-1 when not cached) with remaining triangles still to emit
+static float vertexScore(int cachePosition, int remaining)
+{
+	if (remaining == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// The vertices of the last triangle get a fixed score so it is not immediately reused
+		if (cachePosition < 3)
+			score = LAST_TRIANGLE_SCORE;
+		else
+			score = std::pow(1.0f - (cachePosition - 3) / (float)(VERTEX_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+	}
+	// Vertices with few triangles left are worth finishing off
+	score += VALENCE_BOOST_SCALE * std::pow((float)remaining, -VALENCE_BOOST_POWER);
+	return score;
+}
+
+// Reorders the triangles of a triangle list so neighbouring triangles share vertices while they are
+// still cached, following Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". The winding of
+// every triangle is kept
+template <typename Index>
+void optimizeVertexCache(Index* indices, std::size_t indexCount, std::size_t vertexCount, FrameArena& scratch)
+{
+	std::size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+		return;
+
+	// Triangles of every vertex, as ranges of one shared array. Emitted triangles are
+	// swapped to the end of their vertex's range and the range shrinks
+	int* remaining = scratch.Allocate<int>(vertexCount);
+	std::size_t* firstTriangle = scratch.Allocate<std::size_t>(vertexCount + 1);
+	std::size_t* vertexTriangles = scratch.Allocate<std::size_t>(indexCount);
+	std::memset(remaining, 0, vertexCount * sizeof(int));
+	for (std::size_t i = 0; i < indexCount; i++)
+		remaining[indices[i]]++;
+	firstTriangle[0] = 0;
+	for (std::size_t v = 0; v < vertexCount; v++)
+		firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+	std::size_t* fill = scratch.Allocate<std::size_t>(vertexCount);
+	std::memcpy(fill, firstTriangle, vertexCount * sizeof(std::size_t));
+	for (std::size_t i = 0; i < indexCount; i++)
+		vertexTriangles[fill[indices[i]]++] = i / 3;
+
+	int* cachePosition = scratch.Allocate<int>(vertexCount);
+	float* score = scratch.Allocate<float>(vertexCount);
+	for (std::size_t v = 0; v < vertexCount; v++)
+	{
+		cachePosition[v] = -1;
+		score[v] = vertexScore(-1, remaining[v]);
+	}
+
+	bool* emitted = scratch.Allocate<bool>(triangleCount);
+	std::memset(emitted, 0, triangleCount * sizeof(bool));
+
+	Index* output = scratch.Allocate<Index>(indexCount);
+	// Simulated LRU cache, with room for the 3 vertices pushed in front before trimming
+	Index cache[VERTEX_CACHE_SIZE + 3];
+	Index nextCache[VERTEX_CACHE_SIZE + 3];
+	int cacheCount = 0;
+
+	// Start from the best triangle, afterwards only triangles touching the cache are candidates
+	std::size_t best = 0;
+	float bestScore = -1.0f;
+	for (std::size_t t = 0; t < triangleCount; t++)
+	{
+		float s = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+		if (s > bestScore)
+		{
+			bestScore = s;
+			best = t;
+		}
+	}
+	std::size_t scanFrom = 0;
+
+	for (std::size_t out = 0; out < triangleCount; out++)
+	{
+		if (best == triangleCount)
+		{
+			// Nothing cached has triangles left, continue with the next unemitted triangle in order
+			while (emitted[scanFrom])
+				scanFrom++;
+			best = scanFrom;
+		}
+
+		const Index* triangle = indices + best * 3;
+		output[out * 3] = triangle[0];
+		output[out * 3 + 1] = triangle[1];
+		output[out * 3 + 2] = triangle[2];
+		emitted[best] = true;
+
+		// Take the triangle out of the lists of its vertices
+		for (int k = 0; k < 3; k++)
+		{
+			Index v = triangle[k];
+			std::size_t* list = vertexTriangles + firstTriangle[v];
+			int count = remaining[v];
+			for (int j = 0; j < count; j++)
+			{
+				if (list[j] == best)
+				{
+					list[j] = list[count - 1];
+					list[count - 1] = best;
+					break;
+				}
+			}
+			remaining[v] = count - 1;
+		}
+
+		// Move the triangle's vertices to the front of the cache
+		int nextCount = 0;
+		for (int k = 0; k < 3; k++)
+			nextCache[nextCount++] = triangle[k];
+		for (int j = 0; j < cacheCount; j++)
+		{
+			Index v = cache[j];
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+				nextCache[nextCount++] = v;
+		}
+		for (int j = 0; j < nextCount; j++)
+			cache[j] = nextCache[j];
+		cacheCount = nextCount;
+
+		// Rescore the cached vertices and the triangles around them, the ones pushed out lose their cache score
+		for (int j = 0; j < cacheCount; j++)
+		{
+			Index v = cache[j];
+			cachePosition[v] = (j < VERTEX_CACHE_SIZE) ? j : -1;
+			score[v] = vertexScore(cachePosition[v], remaining[v]);
+		}
+		best = triangleCount;
+		bestScore = -1.0f;
+		for (int j = 0; j < cacheCount; j++)
+		{
+			Index v = cache[j];
+			const std::size_t* list = vertexTriangles + firstTriangle[v];
+			for (int i = 0; i < remaining[v]; i++)
+			{
+				std::size_t t = list[i];
+				const Index* other = indices + t * 3;
+				float s = score[other[0]] + score[other[1]] + score[other[2]];
+				if (s > bestScore)
+				{
+					bestScore = s;
+					best = t;
+				}
+			}
+		}
+		if (cacheCount > VERTEX_CACHE_SIZE)
+			cacheCount = VERTEX_CACHE_SIZE;
+	}
+
+	std::memcpy(indices, output, indexCount * sizeof(Index));
+}
+
+template VertexCacheStats measureVertexCache<unsigned short>(const unsigned short*, std::size_t, std::size_t, FrameArena&);
+template VertexCacheStats measureVertexCache<unsigned int>(const unsigned int*, std::size_t, std::size_t, FrameArena&);
+template void optimizeVertexCache<unsigned short>(unsigned short*, std::size_t, std::size_t, FrameArena&);
+template void optimizeVertexCache<unsigned int>(unsigned int*, std::size_t, std::size_t, FrameArena&);
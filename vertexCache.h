@@ -0,0 +1,37 @@
+#ifndef VERTEX_CACHE_H
+#define VERTEX_CACHE_H
+
+#include<cstddef>
+
+#include"frameArena.h"
+
+// Entries of the post-transform vertex cache the optimizer targets and the statistics simulate
+const int VERTEX_CACHE_SIZE = 32;
+
+// Result of running a triangle list through a simulated FIFO post-transform cache
+struct VertexCacheStats
+{
+	std::size_t triangles;
+	// Distinct vertices referenced by the list
+	std::size_t vertices;
+	// Vertices the cache had to transform
+	std::size_t misses;
+
+	// Average cache miss ratio: transformed vertices per triangle, 0.5 at best for large grids, 3 at worst
+	double ACMR() const;
+	// Average transform to vertex ratio: times each vertex is transformed, 1 at best
+	double ATVR() const;
+	// Adds the counts of another list, as when several chunks are drawn together
+	void Add(const VertexCacheStats& other);
+};
+
+// Simulates a FIFO cache of VERTEX_CACHE_SIZE entries over a triangle list of vertexCount vertices
+template <typename Index>
+VertexCacheStats measureVertexCache(const Index* indices, std::size_t indexCount, std::size_t vertexCount, FrameArena& scratch);
+
+// Reorders the triangles of a triangle list so neighbouring triangles share vertices while they are
+// still cached, following Tom Forsyth's "Linear-Speed Vertex Cache Optimisation". The winding of
+// every triangle is kept
+template <typename Index>
+void optimizeVertexCache(Index* indices, std::size_t indexCount, std::size_t vertexCount, FrameArena& scratch);
+#endif